@@ -66,10 +66,7 @@ int main()
     printf("Performing the voltage stimulation and weight update of the nanowire network\n");
 
     // let the system stabilize
-    for (int i = 0; i < 1000; i++)
-    {
-        update_conductance(ns, lcc);
-    }
+    advance_conductance(ns, lcc, 1000);
 
     // update and stimulate the nanowire network
     printf("Conductance variation: ");
@@ -33,9 +33,12 @@
 
 #define DIRECTORY_FORMAT            "%s/device_%d"
 #define NETWORK_FILE_NAME_FORMAT    "%s/device_%d/nn.nns"
+#define MAPPED_NETWORK_FILE_NAME_FORMAT "%s/device_%d/nn_mapped.nns"
 #define STATE_FILE_NAME_FORMAT      "%s/device_%d/ns_%d.nns"
 #define INTERFACE_FILE_NAME_FORMAT  "%s/device_%d/it_%d.nns"
 #define MEA_FILE_NAME_FORMAT        "%s/device_%d/mea_%d.nns"
 #define COMPONENT_FILE_NAME_FORMAT  "%s/device_%d/cc_%d.nns"
+#define TRAJECTORY_FILE_NAME_FORMAT "%s/device_%d/trajectory.nns"
+#define CURRENTS_FILE_NAME_FORMAT   "%s/device_%d/io.nns"
 
 #endif /* CONFIG_H */
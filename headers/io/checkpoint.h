@@ -0,0 +1,107 @@
+/**
+ * @file checkpoint.h
+ *
+ * @brief Defines an asynchronous writer of the network state, to record the
+ * trajectory of a simulation without stalling it on disk I/O.
+ *
+ * The writer owns a pool of buffers, each able to contain a network state. A
+ * checkpoint copies the state in a free buffer and returns immediately, while
+ * a background thread serializes the buffered states in order, with the
+ * layout of ::serialize_state. If all the buffers are waiting to be written,
+ * a checkpoint blocks until one of them is free (backpressure), bounding the
+ * memory used by the writer.
+ *
+ * Different threads can checkpoint their states on the same writer: each
+ * checkpoint reserves its buffer under the lock of the writer, and the states
+ * are written in the order of the reservations. A state that cannot be
+ * written (e.g., the file cannot be created) does not stop the writer: the
+ * failure is reported and counted, and returned by the next flush.
+ *
+ * @note The writer must not be moved or copied after its creation, as it is
+ * referenced by its background thread.
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "device/datasheet.h"
+#include "device/network.h"
+
+/// @brief Asynchronous writer of the states of a Nanowire Network.
+typedef struct
+{
+    datasheet           ds;         ///< Datasheet of the Nanowire Network.
+    network_topology    nt;         ///< Topology of the Nanowire Network.
+    char*               path;       ///< Base path of the device folder.
+    int                 id;         ///< Identifier of the device.
+
+    int                 depth;      ///< Number of buffers of the pool.
+    double*             buffers;    ///< Pool of buffers, each containing the
+                                    ///< Ys and then the Vs of a state.
+    int*                steps;      ///< Step of the state in each buffer.
+    bool*               ready;      ///< Whether each buffer contains the
+                                    ///< whole state to write.
+    int                 head;       ///< Buffer of the next state to write.
+    int                 count;      ///< Number of reserved buffers, including
+                                    ///< the ones being filled and the one
+                                    ///< being written.
+    int                 failed;     ///< Number of states that could not be
+                                    ///< written since the last flush.
+    bool                stopping;   ///< Whether the writer is being destroyed.
+
+    pthread_t           thread;     ///< Background thread of the writer.
+    pthread_mutex_t     lock;       ///< Lock of the queue of the states.
+    pthread_cond_t      changed;    ///< Signalled at each change of the queue.
+} checkpoint_writer;
+
+/// @brief Create an asynchronous writer of the states of a Nanowire Network,
+/// and start its background thread.
+///
+/// @param[in] ds The datasheet of the Nanowire Network.
+/// @param[in] nt The topology of the Nanowire Network. It must outlive the
+/// writer.
+/// @param[in] path The base path in which put the /device_ID folder. It must
+/// outlive the writer.
+/// @param[in] id The univocal id of the network.
+/// @param[in] depth The number of buffers of the pool, i.e., the maximum
+/// number of states waiting to be written (at least 1).
+/// @param[out] cw The writer. It must be destroyed with
+/// `destroy_checkpoint_writer`.
+/// @return 0 if the writer is created, -1 if its thread cannot be started.
+int create_checkpoint_writer(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int depth,
+    checkpoint_writer* cw
+);
+
+/// @brief Copy a network state in a buffer of the writer, which will
+/// serialize it in background to the file "ns_STEP.nns" of the device. If all
+/// the buffers are in use, wait until one of them is written.
+///
+/// @param[in, out] cw The writer.
+/// @param[in] ns The network state to write. It can be modified as soon as
+/// the function returns.
+/// @param[in] step The id of the network state in a specific instant.
+void checkpoint_state(checkpoint_writer* cw, const network_state ns, int step);
+
+/// @brief Wait until all the states given to the writer have been written.
+///
+/// @param[in, out] cw The writer.
+/// @return 0 if all the states given since the last flush have been written,
+/// -1 if any of them could not be written.
+int flush_checkpoints(checkpoint_writer* cw);
+
+/// @brief Write all the pending states, stop the background thread of the
+/// writer and free its buffers.
+///
+/// @param[in, out] cw The writer to destroy.
+/// @return 0 if all the states given since the last flush have been written,
+/// -1 if any of them could not be written.
+int destroy_checkpoint_writer(checkpoint_writer* cw);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,86 @@
+/**
+ * @file codec.h
+ *
+ * @brief Defines a lossless encoding of a network state as a delta from the
+ * previous one.
+ *
+ * Consecutive states of a simulation differ in few bits: most junctions are
+ * saturated or stable, and the voltages change slowly. Each double of the
+ * state is XORed with its prediction (e.g., the one of the previous state),
+ * so that unchanged values become zero words and slowly changing ones have
+ * their leading bytes (sign, exponent and high mantissa) zero. The XORed
+ * words are then packed in a stream of bytes:
+ * - a token `0x80 | (n - 1)` encodes a run of n (up to 128) zero words;
+ * - a token `z` (0 to 7) encodes a word with z leading zero bytes, followed by
+ *   its 8 - z remaining bytes, from the least significant one.
+ *
+ * The stream is compressed by an adaptive binary range coder: each byte is
+ * coded bit by bit with probabilities learned in its context, i.e., for a
+ * token the kind of the preceding word, and for the byte of a word its
+ * position and the number of leading zero bytes of the word. The repeated
+ * tokens and the skewed high bytes of the changes take a fraction of a byte,
+ * while the low bytes of the mantissa, which are noise, are not reduced.
+ *
+ * A state encoded without a prediction (i.e., a keyframe) is decoded alone:
+ * each double is XORed with the preceding one of the same state (the first
+ * with zero), so that the many junctions at the same conductance are encoded
+ * by runs.
+ *
+ * If the encoding is not smaller than the raw doubles (e.g., a state with
+ * uncorrelated values), the raw doubles are stored instead, so that an
+ * encoded state is never larger than a raw one. A raw encoding is recognized
+ * by its size, which no other encoding has.
+ *
+ * @note The encoding is lossless: on a simulation in which all the junctions
+ * change at each step, the deltas from the previous state are reduced only
+ * by a factor of about 1.3, as the low bytes of the mantissa change as well.
+ * A prediction replaying the evolution of the junctions (see trajectory.h)
+ * leaves only the voltages to encode.
+ */
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+
+/// @brief Return the maximum size of the encoding of an array of doubles.
+///
+/// @param[in] count The number of doubles to encode.
+/// @return The maximum number of bytes of the encoding.
+size_t encoded_bound(int count);
+
+/// @brief Encode an array of doubles as a delta from a previous array, or
+/// from any prediction of the array.
+///
+/// @param[in] xs The array to encode.
+/// @param[in] previous The previous array (or the prediction), or NULL to
+/// encode a keyframe.
+/// @param[in] count The number of doubles of the arrays.
+/// @param[out] out The encoding. It must contain at least
+/// `encoded_bound(count)` bytes.
+/// @return The number of bytes of the encoding, at most `count` doubles.
+size_t encode_delta(
+    const double xs[],
+    const double previous[],
+    int count,
+    unsigned char out[]
+);
+
+/// @brief Decode an array of doubles encoded as a delta from a previous
+/// array. The result is bitwise equal to the encoded array.
+///
+/// @param[in] in The encoding.
+/// @param[in] size The number of bytes of the encoding.
+/// @param[in] previous The previous array (or the prediction) used by the
+/// encoding, or NULL for a keyframe.
+/// @param[in] count The number of doubles of the arrays.
+/// @param[out] xs The decoded array. It can be the previous array itself.
+/// @return 0 if the encoding is decoded, -1 if it is malformed.
+int decode_delta(
+    const unsigned char in[],
+    size_t size,
+    const double previous[],
+    int count,
+    double xs[]
+);
+
+#endif /* CODEC_H */
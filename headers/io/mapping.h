@@ -0,0 +1,71 @@
+/**
+ * @file mapping.h
+ *
+ * @brief Defines a variant of the network file that can be memory-mapped, so
+ * that the topology is loaded without reading and copying it.
+ *
+ * The file is named "nn_mapped.nns" in the folder of the device. It is
+ * composed of a header, with the version of the file, the datasheet, the size
+ * of the nanowire and junction structures and the offset of each section, and
+ * of the Ws and Js sections, aligned to 64 bytes. Mapping the file returns a
+ * topology whose arrays point directly into the mapping: the pages are loaded
+ * on demand and, since the mapping is shared and read-only, they are shared by
+ * all the processes mapping the same device through the page cache.
+ *
+ * @note The file has the memory layout of the machine writing it, so it can
+ * be mapped only by builds with the same structure layout.
+ */
+#ifndef MAPPING_H
+#define MAPPING_H
+
+#include <stddef.h>
+
+#include "device/datasheet.h"
+#include "device/network.h"
+
+/// @brief A network topology mapped from a file.
+typedef struct
+{
+    datasheet           ds;         ///< The datasheet of the network.
+    network_topology    nt;         ///< The topology of the network. Its
+                                    ///< arrays point into the read-only
+                                    ///< mapping: they must not be modified
+                                    ///< nor freed with `destroy_topology`.
+    void*               address;    ///< Start address of the mapping.
+    size_t              size;       ///< Size of the mapping in bytes.
+} mapped_network;
+
+/// @brief Serialize the static characteristics of the network in the format
+/// that can be mapped, in a file named "nn_mapped.nns" in the folder
+/// "device_ID", where ID is the univocal identifier of the NN. If any problem
+/// occurs, the program will exit with an error.
+///
+/// @param[in] ds The datasheet of the Nanowire Network.
+/// @param[in] nt The topology of the Nanowire Network.
+/// @param[in] path The base path in which put the /device_ID folder.
+/// @param[in] id The univocal id of the network.
+void serialize_mapped_network(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id
+);
+
+/// @brief Map the file of a network serialized with
+/// `serialize_mapped_network`, read-only and shared with the other processes
+/// mapping it.
+///
+/// @param[in] path The base path containing the /device_ID folder.
+/// @param[in] id The univocal id of the network.
+/// @param[out] mn The mapped network. It must be unmapped with
+/// `unmap_network`.
+/// @return 0 if the network is mapped, -1 if the file cannot be mapped or
+/// does not match the layout of this build.
+int map_network(char* path, int id, mapped_network* mn);
+
+/// @brief Unmap a mapped network. Its topology cannot be accessed anymore.
+///
+/// @param[in] mn The mapped network to unmap.
+void unmap_network(mapped_network mn);
+
+#endif /* MAPPING_H */
@@ -11,18 +11,20 @@
  * identifier, following a specific naming convention for the files.
  * 
  * The functions ensure that any existing file with the same name will be
- * replaced and will exit with an error if any issue occurs during the file
+ * replaced and report an error if any issue occurs during the file
  * operations.
  * 
  * @note All file paths and names are based on a device identifier and may be
  * overwritten. Ensure that the paths and identifiers are managed appropriately
  * to avoid data loss.
- * @note If any error occurs during serialization, the program will exit with
- * an error.
+ * @note If any error occurs during serialization, the function returns -1
+ * and reports it, without terminating the program.
  */
 #ifndef SERIALIZER_H
 #define SERIALIZER_H
 
+#include <stdio.h>
+
 #include "device/network.h"
 #include "device/component.h"
 #include "interface/interface.h"
@@ -30,15 +32,15 @@
 
 /// @brief Serialize the static characteristics of the Nanowire Network to a
 /// file named "nn.nns" in a folder named "device_ID", where ID is the univocal
-/// identifier of the NN. Any other file named the same will be overwritten. If
-/// any problem occurs, the program will exit with an error.
+/// identifier of the NN. Any other file named the same will be overwritten.
 /// 
 /// @param[in] ds The datasheet to serialize.
 /// @param[in] nt The network topology to serialize.
 /// @param[in] path The base path in which put the /device_ID folder.
 /// @param[in] id The univocal id of the network that will determine its file
 /// name.
-void serialize_network(
+/// @return 0 if the file is successfully written, -1 otherwise.
+int serialize_network(
     const datasheet ds,
     const network_topology nt,
     char* path,
@@ -48,8 +50,7 @@ void serialize_network(
 /// @brief Serialize the network state (a.k.a. electrical equivalent circuit)
 /// to a file named "ns_STEP.nns" in a folder named "device_ID", where ID is
 /// the univocal identifier of the NN and STEP is the snapshot instant. Any
-/// other file named the same will be overwritten. If any problem occurs, the
-/// program will exit with an error.
+/// other file named the same will be overwritten.
 /// 
 /// @param[in] ds The datasheet of the nanowire network to serialize.
 /// @param[in] nt The topology of the nanowire network to serialize.
@@ -58,7 +59,8 @@ void serialize_network(
 /// @param[in] id The univocal id of the network that will determine its file
 /// name.
 /// @param[in] step The id of the network state in a specific instant.
-void serialize_state(
+/// @return 0 if the file is successfully written, -1 otherwise.
+int serialize_state(
     const datasheet ds,
     const network_topology nt,
     const network_state ns,
@@ -70,15 +72,15 @@ void serialize_state(
 /// @brief Serialize a connected component of a nanowire network to a file
 /// named "cc_CC_ID.nns" in a folder named "device_ID", where NN_ID is the
 /// univocal identifier of the NN and CC_ID is the univocal identified of the
-/// CC. Any other file named the same will be overwritten. If any problem
-/// occurs, the program will exit with an error.
+/// CC. Any other file named the same will be overwritten.
 /// 
 /// @param[in] cc The connected component to serialize.
 /// @param[in] path The base path in which put the /device_ID folder.
 /// @param[in] nn_id The univocal id of the network that will determine its
 /// file name.
 /// @param[in] cc_id The index of the connected component.
-void serialize_component(
+/// @return 0 if the file is successfully written, -1 otherwise.
+int serialize_component(
     const connected_component cc,
     char* path,
     int nn_id,
@@ -88,27 +90,58 @@ void serialize_component(
 /// @brief Serialize the network interface to a file named "it_STEP.nns" in a
 /// folder named "device_ID", where ID is the univocal identifier of the NN and
 /// STEP is the instant in which the interface was saved. Any other file named
-/// the same will be overwritten. If any problem occurs, the program will exit
-/// with an error.
+/// the same will be overwritten.
 /// 
 /// @param[in] it The interface to serialize.
 /// @param[in] path The base path in which put the /device_ID folder.
 /// @param[in] id The univocal id of the network that will determine its file
 /// name.
 /// @param[in] step The id of the network interface in a specific instant.
-void serialize_interface(const interface it, char* path, int id, int step);
+/// @return 0 if the file is successfully written, -1 otherwise.
+int serialize_interface(const interface it, char* path, int id, int step);
 
 /// @brief Serialize the network MEA to a file named "mea_STEP.nns" in a
 /// folder named "device_ID", where ID is the univocal identifier of the NN and
 /// STEP is the instant in which the MEA was saved. Any other file named the
-/// same will be overwritten. If any problem occurs, the program will exit with
-/// an error.
+/// same will be overwritten.
 /// 
 /// @param[in] mea The MEA to serialize.
 /// @param[in] path The base path in which put the /device_ID folder.
 /// @param[in] id The univocal id of the network that will determine its file
 /// name.
 /// @param[in] step The id of the network MEA in a specific instant.
-void serialize_mea(const MEA mea, char* path, int id, int step);
+/// @return 0 if the file is successfully written, -1 otherwise.
+int serialize_mea(const MEA mea, char* path, int id, int step);
+
+/// @brief Create and open a file of a device for writing, and write the
+/// version of the file format in it. The folder "device_ID" is created if it
+/// does not exist, and any other file named the same will be overwritten. If
+/// the file cannot be opened, the program will exit with an error.
+///
+/// @param[in] file_type The format of the file name (e.g.,
+/// STATE_FILE_NAME_FORMAT), with the base path, the id of the network and the
+/// id of the file.
+/// @param[in] path The base path in which put the /device_ID folder.
+/// @param[in] nn_id The univocal id of the network.
+/// @param[in] e_id The id of the file in the folder of the device (e.g., the
+/// step of a network state), or -1 if the format does not use it.
+/// @return The file, positioned after the version. It must be closed with
+/// `fclose`.
+FILE* new_file(char* file_type, char* path, int nn_id, int e_id);
+
+/// @brief Create and open a file of a device as ::new_file, reporting the
+/// errors instead of terminating the process. The file is opened for both
+/// writing and reading.
+///
+/// @param[in] file_type The format of the file name (e.g.,
+/// STATE_FILE_NAME_FORMAT), with the base path, the id of the network and the
+/// id of the file.
+/// @param[in] path The base path in which put the /device_ID folder.
+/// @param[in] nn_id The univocal id of the network.
+/// @param[in] e_id The id of the file in the folder of the device, or -1 if
+/// the format does not use it.
+/// @return The file, positioned after the version, or NULL if it cannot be
+/// created or the version cannot be written.
+FILE* create_file(char* file_type, char* path, int nn_id, int e_id);
 
 #endif /* SERIALIZER_H */
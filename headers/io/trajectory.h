@@ -0,0 +1,159 @@
+/**
+ * @file trajectory.h
+ *
+ * @brief Defines a single-file container of the states of a Nanowire Network
+ * along a simulation (i.e., its trajectory).
+ *
+ * The container is a file named "trajectory.nns" in the folder of the device,
+ * instead of a file per state. It is composed of:
+ * - a header, with the version of the file and the number of junctions and
+ *   nanowires of the network;
+ * - a record for each state, with its step followed by the Ys and the Vs of
+ *   the network;
+ * - a footer, written when the container is closed, with an opening that no
+ *   record can begin with, the step of each record, the number of records and
+ *   a marker.
+ *
+ * The records of a container created with `create_trajectory` have a fixed
+ * size, and contain the raw values of the state. Those of a container created
+ * with `create_encoded_trajectory` contain the state encoded as a delta from
+ * a prediction (see codec.h), with a keyframe encoded alone every fixed
+ * number of records. The prediction of a record is the smaller to encode of:
+ * - the previous record;
+ * - the previous record after a step of `update_conductance` at its
+ *   voltages (see ::updated_conductance), which predicts exactly the Ys of a
+ *   simulation alternating the update and the stimulation, leaving only the
+ *   Vs to encode.
+ *
+ * The first byte of an encoded record identifies its prediction. The size of
+ * the records is variable, so the footer also stores the offset of each
+ * record. A state is read by decoding the records from the previous keyframe,
+ * and is bitwise equal to the appended one.
+ *
+ * States can be appended during the simulation, also to a container created
+ * by a previous run, and read in any order by their step. If the footer is
+ * missing or partially written (e.g., the simulation was interrupted), the
+ * index is rebuilt by scanning the complete records, up to the opening of the
+ * footer.
+ */
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "device/datasheet.h"
+#include "device/network.h"
+
+/// @brief Container of the trajectory of a Nanowire Network.
+typedef struct
+{
+    FILE*           file;           ///< The file of the container.
+    int             js_count;       ///< Number of junctions of the network.
+    int             wires_count;    ///< Number of nanowires of the network.
+    int             records_count;  ///< Number of states in the container.
+    int             capacity;       ///< Number of records the index can contain.
+    int*            steps;          ///< Step of each state in the container.
+    bool            sorted;         ///< Whether the steps are non-decreasing, so
+                                    ///< that a step is found by bisection.
+    int             keyframe_period;///< Number of records between two keyframes,
+                                    ///< or 0 if the records are not encoded.
+    long long*      offsets;        ///< Offset of each record in the file.
+    long long       end;            ///< Offset of the end of the last record.
+    double*         previous;       ///< Values of the last record, if encoded.
+    double*         current;        ///< Values of the record being encoded.
+    double*         predicted;      ///< Values predicted for a record by the
+                                    ///< conductance update, if encoded.
+    int*            junctions;      ///< Nanowires of each junction, in pairs,
+                                    ///< if encoded.
+    unsigned char*  buffer;         ///< Encoding of a record, if encoded.
+    unsigned char*  candidate;      ///< Alternative encoding of a record, if
+                                    ///< encoded.
+} trajectory;
+
+/// @brief Create an empty trajectory container in the folder "device_ID",
+/// where ID is the univocal identifier of the NN. Any other container of the
+/// device will be overwritten.
+///
+/// @param[in] ds The datasheet of the Nanowire Network.
+/// @param[in] nt The topology of the Nanowire Network.
+/// @param[in] path The base path in which put the /device_ID folder.
+/// @param[in] id The univocal id of the network.
+/// @param[out] tr The container. It must be closed with `close_trajectory`.
+/// @return 0 if the container is created, -1 if an error occurs.
+int create_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    trajectory* tr
+);
+
+/// @brief Create an empty trajectory container in the folder "device_ID",
+/// whose states are encoded as deltas from the previous ones. Any other
+/// container of the device will be overwritten.
+///
+/// @param[in] ds The datasheet of the Nanowire Network.
+/// @param[in] nt The topology of the Nanowire Network.
+/// @param[in] path The base path in which put the /device_ID folder.
+/// @param[in] id The univocal id of the network.
+/// @param[in] keyframe_period The number of records between two keyframes:
+/// it bounds the records decoded to read a state.
+/// @param[out] tr The container. It must be closed with `close_trajectory`.
+/// @return 0 if the container is created, -1 if an error occurs.
+int create_encoded_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int keyframe_period,
+    trajectory* tr
+);
+
+/// @brief Open the existing trajectory container of a device, to read its
+/// states or to append new ones. The records of the container are encoded
+/// if it has been created encoded.
+///
+/// @param[in] ds The datasheet of the Nanowire Network.
+/// @param[in] nt The topology of the Nanowire Network.
+/// @param[in] path The base path containing the /device_ID folder.
+/// @param[in] id The univocal id of the network.
+/// @param[out] tr The container. It must be closed with `close_trajectory`.
+/// @return 0 if the container is opened, -1 if an error occurs (e.g., if it
+/// does not match the network).
+int open_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    trajectory* tr
+);
+
+/// @brief Append a state at the end of a trajectory container.
+///
+/// @param[in, out] tr The container.
+/// @param[in] ns The network state to append.
+/// @param[in] step The id of the network state in a specific instant.
+/// @return 0 if the state is appended, -1 if an error occurs.
+int append_state(trajectory* tr, const network_state ns, int step);
+
+/// @brief Read a state of a trajectory container. If the step has been
+/// appended more times, the last state is read.
+///
+/// @param[in] tr The container.
+/// @param[in] step The id of the network state to read.
+/// @param[out] ns The network state read. Its arrays are allocated, and must
+/// be freed with `destroy_state`.
+/// @return 0 if the state is read, -1 if the step is not in the container or
+/// an error occurs.
+int read_state(const trajectory tr, int step, network_state* ns);
+
+/// @brief Write the footer of a trajectory container and close its file. The
+/// container is closed even if the footer cannot be written: its records are
+/// recovered by scanning them at the next opening.
+///
+/// @param[in, out] tr The container to close.
+/// @return 0 if the footer is written, -1 if an error occurs.
+int close_trajectory(trajectory tr);
+
+#endif /* TRAJECTORY_H */
@@ -15,14 +15,28 @@
 #include "interface/interface.h"
 #include "interface/mea.h"
 
+#include "io/checkpoint.h"
+#include "io/codec.h"
 #include "io/deserializer.h"
+#include "io/mapping.h"
 #include "io/serializer.h"
+#include "io/trajectory.h"
 
+#include "stimulator/ensemble.h"
+#include "stimulator/kernels.h"
+#include "stimulator/kron.h"
 #include "stimulator/mna.h"
+#include "stimulator/ordering.h"
+#include "stimulator/pattern.h"
+#include "stimulator/reduction.h"
+#include "stimulator/session.h"
+#include "stimulator/stepping.h"
+#include "stimulator/sweep.h"
 #include "stimulator/update.h"
 
 #include "util/components.h"
 #include "util/measures.h"
+#include "util/parallelism.h"
 #include "util/point.h"
 #include "util/tensors.h"
 
@@ -0,0 +1,109 @@
+/**
+ * @file ensemble.h
+ *
+ * @brief Defines functions to simulate an ensemble of copies of the same
+ * connected component, stepped together.
+ *
+ * Hyperparameter and noise studies simulate many copies (members) of the
+ * same device, with different inputs or initial conductances. The state of
+ * the members is stored junction-major and member-minor, i.e., the values of
+ * a junction (or nanowire) for all the members are contiguous. Thus, the
+ * endpoints of each junction are decoded once for all the members, and the
+ * conductance update of a junction is vectorized over the members (see
+ * ::vectorized_exp).
+ *
+ * The MNA systems of the members share the structure and the symbolic
+ * analysis of a cached MNA system (see ::mna_pattern), while their values and
+ * numeric factorizations are computed in parallel over the members.
+ */
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+#include "stimulator/kernels.h"
+#include "stimulator/pattern.h"
+
+/// @brief State of an ensemble of copies of a connected component.
+typedef struct
+{
+    int     members_count;  ///< Number of members of the ensemble.
+    double* Ys;             ///< Conductance of each junction of the CC for
+                            ///< each member: the one of junction k for member
+                            ///< m is `Ys[k * members_count + m]`.
+    double* Vs;             ///< Voltage of each nanowire of the CC for each
+                            ///< member: the one of nanowire i for member m is
+                            ///< `Vs[i * members_count + m]`.
+} ensemble_state;
+
+/// @brief Create an ensemble whose members are all copies of the state of a
+/// connected component.
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component to replicate.
+/// @param[in] members_count The number of members of the ensemble.
+/// @return The ensemble state. It must be destroyed with `destroy_ensemble`.
+ensemble_state create_ensemble(
+    const network_state ns,
+    const connected_component cc,
+    int members_count
+);
+
+/// @brief Copy the state of a member of an ensemble into the state of the
+/// Nanowire Network containing the CC (e.g., to measure it).
+///
+/// @param[in] es The ensemble state.
+/// @param[in] cc The connected component of the ensemble.
+/// @param[in] member The index of the member to copy.
+/// @param[in, out] ns The state of the Nanowire Network containing the CC.
+/// Only the values of the CC are modified.
+void member_state(
+    const ensemble_state es,
+    const connected_component cc,
+    int member,
+    network_state ns
+);
+
+/// @brief Perform a step of `update_conductance` on all the members of an
+/// ensemble, vectorizing the update of each junction over the members.
+///
+/// @param[in, out] es The ensemble state.
+/// @param[in] cc The connected component of the ensemble.
+/// @param[in] kernel The kernel evaluating the exponentials. It must be
+/// supported by the processor in use (see ::best_update_kernel).
+void ensemble_update(
+    ensemble_state es,
+    const connected_component cc,
+    update_kernel kernel
+);
+
+/// @brief Perform the voltage stimulation of all the members of an ensemble
+/// through the structure and symbolic analysis of a cached MNA system. The
+/// result of each member is the same of ::pattern_stimulation.
+///
+/// @param[in, out] es The ensemble state. Its voltages are modified.
+/// @param[in] cc The connected component of the ensemble.
+/// @param[in] it The interface the cached system has been assembled with.
+/// @param[in, out] ios An array with an entry for each source and member: the
+/// one of source i for member m is `ios[i * members_count + m]`. As input
+/// parameter it contains the voltage applied to the sources, as output the
+/// current drawn from them.
+/// @param[in] mp The cached MNA system of the CC. Its values are not
+/// modified.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs.
+int ensemble_stimulation(
+    ensemble_state es,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    const mna_pattern mp
+);
+
+/// @brief Destroy an ensemble state by freeing its pointers.
+///
+/// @param[in, out] es The ensemble state to destroy.
+void destroy_ensemble(ensemble_state es);
+
+#endif /* ENSEMBLE_H */
@@ -0,0 +1,102 @@
+/**
+ * @file kernels.h
+ *
+ * @brief Defines vectorized kernels of the `update_conductance` function.
+ *
+ * The update of the conductance is dominated by the evaluation of three
+ * exponentials per junction. The kernels defined here evaluate them on
+ * several junctions at once with the SIMD instructions of the processor
+ * (AVX2 or AVX-512), gathering the voltages of the junction endpoints through
+ * precomputed indexes instead of decoding the adjacency indexes of the CC.
+ *
+ * The vectorized exponential reduces the argument as x = n * ln(2) + r, with
+ * |r| <= ln(2) / 2, and evaluates e^r with a degree-13 polynomial. Its
+ * relative error is below 1e-15 (a few ULPs) for arguments in [-708, 709];
+ * smaller arguments return 0 and larger ones return infinity.
+ *
+ * The kernel is selected at runtime among the ones supported by the
+ * processor (see `supported_update_kernel`), falling back to the scalar one,
+ * which is equivalent to `update_conductance`.
+ */
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stdbool.h>
+
+#include "device/network.h"
+#include "util/components.h"
+
+/// @brief Enumeration of the kernels available for the conductance update.
+typedef enum
+{
+    SCALAR_KERNEL,  ///< Portable kernel relying on the C math library.
+    AVX2_KERNEL,    ///< Kernel processing 4 junctions at once with AVX2 and
+                    ///< FMA instructions.
+    AVX512_KERNEL   ///< Kernel processing 8 junctions at once with AVX-512F
+                    ///< instructions.
+} update_kernel;
+
+/// @brief Plan of the conductance update of the junctions of a Connected
+/// Component, with the endpoints of each junction already decoded.
+typedef struct
+{
+    update_kernel   kernel;     ///< The kernel performing the update.
+    int             js_count;   ///< Number of junctions in the CC.
+    int             js_skip;    ///< Index of the first junction of the CC in
+                                ///< the network state.
+    int*            Ei;         ///< Index of the first endpoint of each
+                                ///< junction in the network state.
+    int*            Ej;         ///< Index of the second endpoint of each
+                                ///< junction in the network state.
+} update_plan;
+
+/// @brief Check if a kernel is supported by the processor in use.
+///
+/// @param[in] kernel The kernel to check.
+/// @return True if the kernel can be used, false otherwise.
+bool supported_update_kernel(update_kernel kernel);
+
+/// @brief Get the fastest kernel supported by the processor in use.
+///
+/// @return The kernel with the largest vector width supported.
+update_kernel best_update_kernel();
+
+/// @brief Create the plan of the conductance update of a Connected Component.
+///
+/// @param[in] cc The Connected Component whose junctions to update.
+/// @param[in] kernel The kernel performing the update.
+/// @param[out] up The plan of the update. It must be destroyed with
+/// `destroy_update_plan`.
+/// @return 0 if the plan is created, -1 if the kernel is not supported by the
+/// processor in use.
+int create_update_plan(
+    const connected_component cc,
+    update_kernel kernel,
+    update_plan* up
+);
+
+/// @brief Perform a step of `update_conductance` with the kernel of a plan.
+/// The result matches the scalar update up to the accuracy of the vectorized
+/// exponential.
+///
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in] up The plan of the update.
+void vectorized_update(network_state ns, const update_plan up);
+
+/// @brief Evaluate the exponential of an array with the given kernel. It is
+/// the function used by `vectorized_update`, exposed for its validation.
+///
+/// @param[in] kernel The kernel evaluating the exponential. It must be
+/// supported by the processor in use.
+/// @param[in] xs The arguments of the exponential.
+/// @param[out] ys The exponential of each argument.
+/// @param[in] n The length of the arrays.
+void vectorized_exp(update_kernel kernel, const double xs[], double ys[], int n);
+
+/// @brief Destroy a plan of the conductance update by freeing its pointers.
+///
+/// @param[in, out] up The plan to destroy.
+void destroy_update_plan(update_plan up);
+
+#endif /* KERNELS_H */
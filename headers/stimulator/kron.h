@@ -0,0 +1,96 @@
+/**
+ * @file kron.h
+ *
+ * @brief Defines functions to stimulate a frozen connected component through
+ * its Kron reduction onto the electrodes.
+ *
+ * When the conductance of a Nanowire Network does not change (e.g., a trained
+ * device used as a fixed reservoir), the MNA system is linear in the voltages
+ * applied to the sources. Therefore, the current drawn by the sources and the
+ * voltage of any nanowire are linear combinations of the input voltages:
+ * ```
+ *      io_out = K * io_in          V = M * io_in
+ * ```
+ * K is the Schur complement of the conductance matrix onto the sources (Kron
+ * reduction), while M is the voltage response of the nanowires. Both are
+ * computed once with a stimulation per source, after which each input is
+ * answered by a small dense matrix-vector product. The stimulations share the
+ * same system, which is factorized only once unless a reduction is used.
+ *
+ * @note The reduction is valid only as long as the conductance of the
+ * junctions does not change; it must be recomputed after any update.
+ */
+#ifndef KRON_H
+#define KRON_H
+
+#include <stdbool.h>
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+#include "stimulator/mna.h"
+
+/// @brief Kron reduction of a frozen connected component onto the sources of
+/// an interface.
+typedef struct
+{
+    int     sources_count;  ///< Number of sources of the interface connected
+                            ///< to the CC.
+    int*    sources;        ///< Index in the io array of each source connected
+                            ///< to the CC.
+    double* Ks;             ///< Row-major matrix (sources_count x
+                            ///< sources_count) mapping the source voltages to
+                            ///< the drawn currents.
+    int     ws_count;       ///< Number of nanowires whose voltage is
+                            ///< reconstructed.
+    int*    ws_index;       ///< Index of the reconstructed nanowires in the
+                            ///< network state.
+    double* Ms;             ///< Row-major matrix (ws_count x sources_count)
+                            ///< mapping the source voltages to the voltage of
+                            ///< the reconstructed nanowires.
+} kron_reduction;
+
+/// @brief Compute the Kron reduction of a frozen connected component onto the
+/// sources of an interface by stimulating each source with a unitary voltage.
+///
+/// @param[in, out] ns The state of the Nanowire Network containing the CC.
+/// Its conductances are read, while its voltages are used as workspace and
+/// must be considered overwritten.
+/// @param[in] cc The connected component to reduce.
+/// @param[in] it The interface that will be used to stimulate the CC.
+/// @param[in] full If true, the voltage response of all the nanowires of the
+/// CC is stored; otherwise, only that of the electrodes is stored.
+/// @param[in] settings The settings of the MNA solver used for the unitary
+/// stimulations.
+/// @param[out] kr The Kron reduction of the CC. It must be destroyed with
+/// ::destroy_kron_reduction.
+/// @return 0 if the computation successfully terminates, -1 if an error occurs
+/// (e.g. if the sources/grounds/loads nanowires are not connected).
+int kron_reduce(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    bool full,
+    const mna_settings settings,
+    kron_reduction* kr
+);
+
+/// @brief Perform the voltage stimulation of a frozen connected component
+/// through its Kron reduction. The result is the same of
+/// ::voltage_stimulation, but only the voltage of the nanowires stored in the
+/// reduction is set.
+///
+/// @param[in, out] ns The state of the Nanowire Network containing the CC.
+/// Only the voltage of the nanowires stored in the reduction is modified.
+/// @param[in] kr The Kron reduction of the CC.
+/// @param[in, out] io An array with an entry for each source of the interface.
+/// As input parameter it contains the voltage applied to a source, as output
+/// it contains the current drawn from that node.
+void kron_stimulation(network_state ns, const kron_reduction kr, double io[]);
+
+/// @brief Destroy a Kron reduction by freeing its pointers.
+///
+/// @param[in, out] kr The Kron reduction to destroy.
+void destroy_kron_reduction(kron_reduction kr);
+
+#endif /* KRON_H */
@@ -16,6 +16,10 @@
  * simply converts the MEA into an interface before passing it to the main
  * function.
  * 
+ * The stimulation can be tuned through the ::mna_settings structure, e.g., to
+ * provide a precomputed fill-reducing ordering of the nanowires, or to solve
+ * an equivalent reduced connected component.
+ *
  * @note The MNA implementation leverages UMFPACK functions for efficient
  * computation.
  */
@@ -26,6 +30,40 @@
 #include "device/component.h"
 #include "interface/interface.h"
 #include "interface/mea.h"
+#include "stimulator/reduction.h"
+
+/// @brief Enumeration of the solvers available for the MNA system.
+typedef enum
+{
+    DIRECT_SOLVER,      ///< Sequential UMFPACK factorization of the whole
+                        ///< system.
+    SCHUR_SOLVER        ///< Domain decomposition: the subdomains are
+                        ///< factorized in parallel, and the Schur complement
+                        ///< of their interface is solved (see ::schur_solve).
+} solver_t;
+
+/// @brief Settings of the MNA solver. A zero-initialized structure specifies
+/// the default behaviour of ::voltage_stimulation.
+typedef struct
+{
+    const int*  Qs;             ///< Optional fill-reducing ordering of the
+                                ///< nanowires of the CC (see
+                                ///< ::geometric_ordering). If NULL, UMFPACK
+                                ///< computes its own ordering at each call.
+                                ///< Used only by the DIRECT_SOLVER.
+    solver_t    solver;         ///< The solver of the MNA system.
+    int         domains_count;  ///< Number of subdomains of the CC. Used only
+                                ///< by the SCHUR_SOLVER.
+    const int*  Ds;             ///< Subdomain of each nanowire of the CC, or
+                                ///< -1 if in the interface (see
+                                ///< ::spatial_partition). Used only by the
+                                ///< SCHUR_SOLVER.
+    const reduced_component* reduction; ///< Optional reduction of the CC
+                                ///< (see ::reduce_component). If given, the
+                                ///< reduced CC is solved in place of the
+                                ///< original one; Qs and Ds must then refer to
+                                ///< the nanowires of the reduced CC.
+} mna_settings;
 
 /// @brief Perform the voltage stimulation of the Nanowire Network by
 /// using the Modified Nodal Analysis algorithm. It does not update the
@@ -61,6 +99,53 @@ int voltage_stimulation(
     double io[]
 );
 
+/// @brief Perform the voltage stimulation of the Nanowire Network according
+/// to the specified solver settings. See ::voltage_stimulation for more
+/// details.
+/// 
+/// @param[in, out] ns The Nanowire Network equivalent electrical circuit
+/// on which performing the MNA. Only the voltage value of the nodes belonging
+/// to the passed CC will be modified.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @param[in] settings The settings of the MNA solver.
+/// @return 0 if the computation successfully terminates, -1 if an error occurs
+/// (e.g. if the sources/grounds/loads nanowires are not connected).
+int voltage_stimulation_with(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_settings settings
+);
+
+/// @brief Estimate the maximum error of the voltages of a connected component
+/// w.r.t. the exact MNA solution (e.g., after an approximate stimulation). The
+/// residual of the Kirchhoff's current law in each nanowire that is neither a
+/// source nor a ground is divided by its total conductance, i.e., it is the
+/// voltage correction of a Jacobi iteration on the error equations.
+///
+/// @note The estimate is not a bound: the actual error can be larger,
+/// especially in poorly conditioned CCs where a small residual spreads over
+/// many nanowires.
+/// 
+/// @param[in] ns The Nanowire Network equivalent electrical circuit, with the
+/// voltages to check.
+/// @param[in] cc The connected component of `ns` to check.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @return The estimated maximum voltage error of the nanowires of the CC (in
+/// volts), i.e., their maximum scaled residual.
+double voltage_error_estimate(
+    const network_state ns,
+    const connected_component cc,
+    const interface it
+);
+
 /// @brief Perform the voltage stimulation of a Nanowire Network connected with
 /// a MEA. See ::voltage_stimulation for more details.
 /// 
@@ -0,0 +1,63 @@
+/**
+ * @file ordering.h
+ *
+ * @brief Defines functions to compute a fill-reducing ordering and a spatial
+ * partition of the nanowires of a connected component from their position in
+ * the package.
+ *
+ * The nanowires of a Nanowire Network are randomly dropped on a plane and only
+ * touch their geometric neighbours. Therefore, a straight cut of the package
+ * splits a connected component in two halves joined by a thin layer of
+ * nanowires (i.e., a separator). Recursively numbering the two halves before
+ * their separator (geometric nested dissection) limits the fill-in produced by
+ * the factorization of the MNA matrix. Stopping the recursion after a given
+ * number of splits produces instead independent subdomains joined only by the
+ * separators, as required by a domain-decomposition solver.
+ *
+ * @note The ordering and the partition depend only on the topology of the
+ * network. Therefore, they can be computed once and reused for all the
+ * stimulations of a connected component (see ::mna_settings).
+ */
+#ifndef ORDERING_H
+#define ORDERING_H
+
+#include "device/network.h"
+#include "device/component.h"
+
+/// @brief Compute a geometric nested-dissection ordering of the nanowires of a
+/// connected component. At each level, the nanowires are split at the median
+/// centroid along the widest side of their bounding box, and the nanowires of
+/// one half touching the other half are moved to the separator. The two halves
+/// are recursively ordered before their separator.
+///
+/// @param[in] nt The topology of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component whose nanowires to order.
+/// @param[out] Qs An array of length `cc.ws_count` containing, for each
+/// position, the index (relative to the CC) of the nanowire to eliminate in
+/// that position.
+void geometric_ordering(
+    const network_topology nt,
+    const connected_component cc,
+    int Qs[]
+);
+
+/// @brief Partition the nanowires of a connected component in spatial
+/// subdomains by recursively splitting them along the widest side of their
+/// bounding box. The nanowires of a subdomain touching another subdomain are
+/// moved to the interface, so that the subdomains are connected only through
+/// it.
+///
+/// @param[in] nt The topology of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component whose nanowires to partition.
+/// @param[in] domains_count The number of subdomains to create.
+/// @param[out] Ds An array of length `cc.ws_count` containing, for each
+/// nanowire of the CC, the index of its subdomain in [0, domains_count), or -1
+/// if the nanowire belongs to the interface.
+void spatial_partition(
+    const network_topology nt,
+    const connected_component cc,
+    int domains_count,
+    int Ds[]
+);
+
+#endif /* ORDERING_H */
@@ -0,0 +1,229 @@
+/**
+ * @file pattern.h
+ *
+ * @brief Defines a cached MNA system of a connected component, whose values
+ * are refilled in place at each step.
+ *
+ * The structure of the MNA system of a connected component only depends on
+ * its junctions and on the interface used to stimulate it. Assembling it
+ * once, together with the position in the matrix of the entries of each
+ * junction and with its symbolic analysis, reduces each step to the refill of
+ * the matrix values and to its numeric factorization.
+ *
+ * Moreover, the conductance update can directly scatter the new value of each
+ * junction in the matrix (see `fused_update`), saving a pass over the
+ * junctions of the network at each step.
+ *
+ * Finally, as the voltages evolve smoothly between the steps (except during
+ * the switching of the junctions), the solution of a step can be
+ * extrapolated from the last ones and accepted if its Kirchhoff residual is
+ * small enough (see `predicted_stimulation`), skipping the factorization.
+ */
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+#include "stimulator/mna.h"
+
+/// @brief MNA system of a connected component, assembled once and refilled
+/// at each step.
+typedef struct
+{
+    int     size;       ///< Number of unknowns of the system (voltage of the
+                        ///< nanowires not grounded, then current of the
+                        ///< sources).
+    int*    Ap;         ///< Start of each column of the system.
+    int*    Ai;         ///< Row of each entry of the system.
+    double* Ax;         ///< Value of each entry of the system.
+    int*    Jx;         ///< Position in Ax of the 4 entries of each junction:
+                        ///< the diagonal of its endpoints and the two
+                        ///< off-diagonal entries, or -1 if the entry is not
+                        ///< in the system (i.e., grounded endpoint).
+    int*    Dx;         ///< Position in Ax of the diagonal of each nanowire of
+                        ///< the CC, or -1 if grounded.
+    double* ws;         ///< Weight of the load connected to each nanowire of
+                        ///< the CC (0 if none).
+    int*    n2x;        ///< Unknown of each nanowire of the CC, or -1 if
+                        ///< grounded.
+    int*    s2x;        ///< Unknown of the current of each source of the
+                        ///< interface, or -1 if not connected to the CC.
+    void*   Symbolic;   ///< Symbolic analysis of the system.
+} mna_pattern;
+
+/// @brief Predictor of the solution of a cached MNA system from the
+/// solutions of the last steps.
+typedef struct
+{
+    int     order;          ///< Order of the extrapolation: 1 (linear) or 2
+                            ///< (quadratic).
+    double  tolerance;      ///< Maximum residual of a predicted solution, in
+                            ///< volts (i.e., scaled by the diagonal of each
+                            ///< row of the system).
+    int     step;           ///< Number of stimulations performed.
+    int     history_count;  ///< Number of solutions stored.
+    int*    steps;          ///< Step of each stored solution.
+    double* xs;             ///< Last solved solutions of the system, from the
+                            ///< most recent one.
+    long    solves_count;   ///< Number of systems solved.
+    long    skips_count;    ///< Number of predicted solutions accepted.
+} predictor;
+
+/// @brief Assemble the MNA system of a connected component with the
+/// conductance of the given state, and perform its symbolic analysis.
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component to stimulate.
+/// @param[in] it The interface that will be used to stimulate the CC.
+/// @param[in] settings The settings of the MNA solver. Only the DIRECT_SOLVER
+/// without reductions is supported; if given, the ordering Qs is used for the
+/// symbolic analysis.
+/// @param[out] mp The cached MNA system. It must be destroyed with
+/// `destroy_pattern`.
+/// @return 0 if the system is assembled, -1 if an error occurs (e.g., if the
+/// settings are not supported).
+int create_pattern(
+    const network_state ns,
+    const connected_component cc,
+    const interface it,
+    const mna_settings settings,
+    mna_pattern* mp
+);
+
+/// @brief Refill the values of a cached MNA system with the conductance of
+/// the given state (e.g., after a conductance update not fused with it).
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component of the system.
+/// @param[in, out] mp The cached MNA system.
+void refill_pattern(
+    const network_state ns,
+    const connected_component cc,
+    mna_pattern mp
+);
+
+/// @brief Perform a step of `update_conductance` and scatter the new
+/// conductance of each junction in the cached MNA system, in a single pass
+/// over the junctions.
+///
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in, out] mp The cached MNA system of the CC.
+void fused_update(
+    network_state ns,
+    const connected_component cc,
+    mna_pattern mp
+);
+
+/// @brief Perform the voltage stimulation of a connected component by
+/// solving its cached MNA system. The result is the same of
+/// ::voltage_stimulation with the conductance last filled in the system.
+///
+/// @param[in, out] ns The Nanowire Network equivalent electrical circuit.
+/// Only the voltage value of the nodes belonging to the CC will be modified.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface the system has been assembled with.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @param[in] mp The cached MNA system of the CC.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs.
+int pattern_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp
+);
+
+/// @brief Compute the numeric factorization of the values filled in a cached
+/// MNA system, so that it can be solved for several inputs (e.g., one per
+/// source) with `factorized_stimulation`.
+///
+/// @param[in] mp The cached MNA system.
+/// @param[out] Numeric The numeric factorization. It must be destroyed with
+/// `destroy_factorization`, and it is valid until the system is refilled.
+/// @return 0 if the system is factorized, -1 if it is singular.
+int factorize_pattern(const mna_pattern mp, void** Numeric);
+
+/// @brief Perform the voltage stimulation of a connected component with the
+/// numeric factorization of its cached MNA system. The result is the same of
+/// `pattern_stimulation`, without factorizing the system again.
+///
+/// @param[in, out] ns The Nanowire Network equivalent electrical circuit.
+/// Only the voltage value of the nodes belonging to the CC will be modified.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface the system has been assembled with.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @param[in] mp The cached MNA system of the CC.
+/// @param[in] Numeric The numeric factorization of the system.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs.
+int factorized_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    void* Numeric
+);
+
+/// @brief Destroy the numeric factorization of a cached MNA system.
+///
+/// @param[in] Numeric The numeric factorization to destroy.
+void destroy_factorization(void* Numeric);
+
+/// @brief Create a predictor of the solution of a cached MNA system.
+///
+/// @param[in] mp The cached MNA system whose solution to predict.
+/// @param[in] order The order of the extrapolation: 1 (linear) or 2
+/// (quadratic).
+/// @param[in] tolerance The maximum residual of an accepted prediction, in
+/// volts.
+/// @return The predictor. It must be destroyed with `destroy_predictor`.
+predictor create_predictor(const mna_pattern mp, int order, double tolerance);
+
+/// @brief Perform the voltage stimulation of a connected component through
+/// its cached MNA system, extrapolating the solution from the last solved
+/// steps.
+/// The prediction is accepted if its residual, computed with a sparse
+/// matrix-vector product, is within the tolerance; otherwise, the system is
+/// solved as in `pattern_stimulation`.
+///
+/// @param[in, out] ns The Nanowire Network equivalent electrical circuit.
+/// Only the voltage value of the nodes belonging to the CC will be modified.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface the system has been assembled with.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @param[in] mp The cached MNA system of the CC.
+/// @param[in, out] pr The predictor of the solution.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs.
+int predicted_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    predictor* pr
+);
+
+/// @brief Destroy a predictor by freeing its pointers.
+///
+/// @param[in, out] pr The predictor to destroy.
+void destroy_predictor(predictor pr);
+
+/// @brief Destroy a cached MNA system by freeing its pointers.
+///
+/// @param[in, out] mp The cached MNA system to destroy.
+void destroy_pattern(mna_pattern mp);
+
+#endif /* PATTERN_H */
@@ -0,0 +1,169 @@
+/**
+ * @file reduction.h
+ *
+ * @brief Defines functions to reduce a connected component to an equivalent
+ * smaller circuit before its Modified Nodal Analysis.
+ *
+ * Many nanowires of a connected component do not affect the voltage of the
+ * electrodes. E.g., a tree of nanowires hanging from the CC and not containing
+ * any electrode carries no current, and all its nanowires have the voltage of
+ * the nanowire it is attached to. Removing them from the MNA system reduces
+ * the cost of its factorization without changing the solution.
+ *
+ * More generally, the CC can be decomposed in biconnected blocks joined by
+ * articulation nanowires (block-cut tree): only the blocks lying on a path
+ * between two electrodes carry current, while the others hang at the voltage
+ * of an articulation nanowire.
+ *
+ * Similarly, a chain of nanowires with only two neighbours behaves as a single
+ * junction whose resistance is the sum of the resistances of the chain, and
+ * the voltage of its nanowires can be interpolated from the current flowing
+ * through it.
+ *
+ * Finally, a CC can be approximated by contracting the nanowires joined by
+ * saturated junctions and by ignoring the weakest junctions, trading a
+ * controlled accuracy loss for a smaller system.
+ *
+ * The topology of a reduction can be computed once and reused for all the
+ * stimulations of a connected component with the same interface (see
+ * ::mna_settings), while the equivalent conductances are recomputed from the
+ * network state at each stimulation.
+ */
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+
+/// @brief Enumeration of the reductions applicable to a connected component.
+/// The values can be combined as flags.
+typedef enum
+{
+    DANGLING_TREES = 1 << 0,    ///< Prune the trees of nanowires without any
+                                ///< electrode hanging from the CC. The pruned
+                                ///< nanowires take the voltage of the nanowire
+                                ///< their tree is attached to.
+    SERIES_PARALLEL = 1 << 1,   ///< Collapse the chains of nanowires with two
+                                ///< neighbours and no electrode into a single
+                                ///< junction, and merge the junctions between
+                                ///< the same nanowires. The voltage of the
+                                ///< collapsed nanowires is interpolated along
+                                ///< their chain.
+    PASSIVE_BLOCKS = 1 << 2     ///< Prune the biconnected blocks of the CC not
+                                ///< lying on a path between two electrodes.
+                                ///< The pruned nanowires take the voltage of
+                                ///< the articulation nanowire their blocks
+                                ///< hang from. It generalizes DANGLING_TREES.
+} reduction_t;
+
+/// @brief Connected component reduced to an equivalent smaller circuit,
+/// together with the information needed to reconstruct the voltage of the
+/// nanowires of the original CC.
+///
+/// Each junction of the reduced CC is made of one or more terms in parallel,
+/// and each term is a chain of junctions of the original CC in series. E.g.,
+/// the junctions of the term `t` are `Cj[Cp[t]] .. Cj[Cp[t + 1] - 1]`, ordered
+/// from the endpoint with the lower index in the reduced CC, and `Cw[e]` is
+/// the nanowire reached through the junction `Cj[e]`.
+typedef struct
+{
+    connected_component cc;     ///< The reduced CC. Its nanowires and
+                                ///< junctions refer to a dedicated network
+                                ///< state (i.e., ws_skip = js_skip = 0).
+    int*                w2r;    ///< For each nanowire of the original CC, its
+                                ///< index in the reduced CC, or -1 if removed.
+    int*                anchor; ///< For each nanowire of the original CC, the
+                                ///< nanowire of the original CC sharing its
+                                ///< voltage (itself if in the reduced CC or
+                                ///< in a chain).
+    int*                Tp;     ///< Start of the terms of each junction of the
+                                ///< reduced CC (length `cc.js_count + 1`).
+    int*                Cp;     ///< Start of the chain of each term in Cj/Cw.
+    int*                Cj;     ///< Junctions of the original CC in each chain.
+    int*                Cw;     ///< Nanowires of the original CC in each chain.
+} reduced_component;
+
+/// @brief Reduce a connected component according to the given passes. The
+/// nanowires referenced by the interface are never removed.
+///
+/// @param[in] cc The connected component to reduce.
+/// @param[in] it The interface that will be used to stimulate the CC.
+/// @param[in] passes The reductions to apply, as a combination of
+/// ::reduction_t flags.
+/// @return The reduced connected component. It must be destroyed with
+/// ::destroy_reduction.
+reduced_component reduce_component(
+    const connected_component cc,
+    const interface it,
+    int passes
+);
+
+/// @brief Approximate a connected component by contracting its saturated
+/// junctions and dropping its weakest ones, according to their conductance
+/// in the given state. The nanowires joined by a junction with conductance
+/// close to Y_MAX are merged in a super-node (i.e., the junction is treated
+/// as a short-circuit), while the junctions with conductance close to Y_MIN
+/// are removed (i.e., treated as open-circuits), unless needed to connect a
+/// region of the CC to its electrodes. The nanowires referenced by the
+/// interface are never merged together.
+///
+/// @note The contraction is an approximation, valid as long as the
+/// saturation pattern of the junctions does not change. The error of a
+/// stimulation can be estimated with ::voltage_error_estimate.
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC.
+/// @param[in] cc The connected component to contract.
+/// @param[in] it The interface that will be used to stimulate the CC.
+/// @param[in] merge_tolerance The relative distance from Y_MAX under which a
+/// junction is contracted (e.g., 0.05 merges the junctions above 0.95 Y_MAX).
+/// @param[in] drop_tolerance The relative distance from Y_MIN under which a
+/// junction is dropped (e.g., 0.05 drops the junctions below 1.05 Y_MIN).
+/// @return The contracted connected component. It must be destroyed with
+/// ::destroy_reduction.
+reduced_component contract_component(
+    const network_state ns,
+    const connected_component cc,
+    const interface it,
+    double merge_tolerance,
+    double drop_tolerance
+);
+
+/// @brief Calculate the equivalent conductance of the junctions of a reduced
+/// connected component from the state of the original network. Not supposed
+/// to be used directly by the user (see ::voltage_stimulation_with).
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC.
+/// @param[in] cc The original connected component.
+/// @param[in] rc The reduction of the connected component.
+/// @param[out] rs The state of the reduced CC. Only its Ys array is set.
+void reduce_state(
+    const network_state ns,
+    const connected_component cc,
+    const reduced_component rc,
+    network_state rs
+);
+
+/// @brief Scatter the voltage of the nanowires of a reduced connected
+/// component to all the nanowires of the original one, interpolating the
+/// voltage of the nanowires in the chains. Not supposed to be used directly by
+/// the user (see ::voltage_stimulation_with).
+///
+/// @param[in, out] ns The state of the Nanowire Network containing the CC.
+/// Only the voltage of the nanowires belonging to the CC is modified.
+/// @param[in] cc The original connected component.
+/// @param[in] rc The reduction of the connected component.
+/// @param[in] rs The state of the reduced CC, containing its voltages.
+void expand_state(
+    network_state ns,
+    const connected_component cc,
+    const reduced_component rc,
+    const network_state rs
+);
+
+/// @brief Destroy a reduced connected component by freeing its pointers.
+///
+/// @param[in, out] rc The reduced connected component to destroy.
+void destroy_reduction(reduced_component rc);
+
+#endif /* REDUCTION_H */
@@ -0,0 +1,54 @@
+/**
+ * @file schur.h
+ *
+ * @brief Defines a domain-decomposition solver for sparse systems of
+ * equations. Not supposed to be used directly by the user (see
+ * ::voltage_stimulation_with).
+ *
+ * The unknowns of the system are divided in independent subdomains and in an
+ * interface connecting them:
+ * ```
+ *      | A_11           A_1Γ |   | x_1 |   | b_1 |
+ *      |      ...       ...  | * | ... | = | ... |
+ *      |           A_pp A_pΓ |   | x_p |   | b_p |
+ *      | A_Γ1 ... A_Γp  A_ΓΓ |   | x_Γ |   | b_Γ |
+ * ```
+ * The subdomains are factorized in parallel and their contribution is
+ * condensed in the Schur complement of the interface:
+ * ```
+ *      S = A_ΓΓ - Σ A_Γd * A_dd^-1 * A_dΓ
+ * ```
+ * whose solution x_Γ allows to independently solve each subdomain.
+ */
+#ifndef SCHUR_H
+#define SCHUR_H
+
+/// @brief Solve a square sparse system of equations by decomposing it in
+/// subdomains connected through an interface. The subdomains are solved in
+/// parallel with UMFPACK, while the (dense) Schur complement of the interface
+/// is solved sequentially.
+///
+/// @param[in] size The number of unknowns of the system.
+/// @param[in] Ap The column pointers of the matrix in compressed-column form.
+/// @param[in] Ai The row indexes of the matrix entries, sorted in each column.
+/// @param[in] Ax The values of the matrix entries.
+/// @param[out] x The solution of the system.
+/// @param[in] b The right-hand side of the system.
+/// @param[in] dom An array of length `size` containing the subdomain of each
+/// unknown in [0, domains_count), or -1 if it belongs to the interface. The
+/// matrix must not couple unknowns of different subdomains.
+/// @param[in] domains_count The number of subdomains.
+/// @return 0 if the computation successfully terminates, -1 if an error occurs
+/// (e.g. if a subdomain or the interface is singular).
+int schur_solve(
+    int size,
+    const int Ap[],
+    const int Ai[],
+    const double Ax[],
+    double x[],
+    const double b[],
+    const int dom[],
+    int domains_count
+);
+
+#endif /* SCHUR_H */
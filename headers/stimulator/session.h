@@ -0,0 +1,111 @@
+/**
+ * @file session.h
+ *
+ * @brief Defines a simulation session, the reentrant unit of simulation of a
+ * connected component.
+ *
+ * A session owns everything a simulation step needs besides the network
+ * state: the settings of the MNA solver, the workspaces reused between the
+ * steps (i.e., the cached MNA system, see ::mna_pattern), the buffer of its
+ * last error, and the number of threads it is allowed to use.
+ *
+ * Different sessions can be driven concurrently from different threads
+ * (e.g., one device per request thread), provided that they do not share the
+ * state of their nanowires and junctions:
+ * - the error messages of a session are saved in its buffer, instead of being
+ *   printed on the standard output, and the errors of the MNA system (e.g., a
+ *   singular matrix) are returned instead of terminating the process. Only a
+ *   failed memory allocation still terminates it, as everywhere else in the
+ *   library (see `vector` and `zeros_vector`);
+ * - UMFPACK is always called with the default (read-only) control
+ *   parameters, and each session owns its symbolic analysis;
+ * - the parallel regions opened by a session use at most its thread budget,
+ *   so that the sum of the budgets bounds the threads of the process. When a
+ *   session is driven inside a parallel region of the caller, its regions are
+ *   executed by the calling thread only.
+ */
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdbool.h>
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+#include "stimulator/mna.h"
+#include "stimulator/pattern.h"
+#include "util/errors.h"
+
+/// @brief Simulation session of a connected component.
+typedef struct
+{
+    network_state           ns;             ///< State of the Nanowire Network
+                                            ///< containing the CC.
+    connected_component     cc;             ///< Connected component simulated.
+    interface               it;             ///< Interface of the Nanowire
+                                            ///< Network with the external
+                                            ///< world.
+    mna_settings            settings;       ///< Settings of the MNA solver.
+    int                     threads_count;  ///< Maximum number of threads used
+                                            ///< by the session.
+    bool                    cached;         ///< Whether the MNA system is
+                                            ///< cached in the pattern (only
+                                            ///< with the supported settings,
+                                            ///< see ::create_pattern).
+    mna_pattern             mp;             ///< Cached MNA system of the CC.
+    char error[ERROR_LENGTH];               ///< Message of the last error, or
+                                            ///< empty if none.
+} session;
+
+/// @brief Create a simulation session of a connected component.
+///
+/// @param[in] ns The state of the Nanowire Network containing the CC. It is
+/// not copied: it must outlive the session, and must not be shared with
+/// sessions driven concurrently.
+/// @param[in] cc The connected component to simulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in] settings The settings of the MNA solver.
+/// @param[in] threads_count The maximum number of threads used by the
+/// session (at least 1).
+/// @param[out] s The session. It must be destroyed with `destroy_session`.
+/// @return 0 if the session is created, -1 if an error occurs; the message of
+/// the error is saved in the session.
+int create_session(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    const mna_settings settings,
+    int threads_count,
+    session* s
+);
+
+/// @brief Perform the voltage stimulation of the connected component of a
+/// session, as ::voltage_stimulation_with.
+///
+/// @param[in, out] s The session.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs; the message of the error is saved in the session.
+int session_stimulation(session* s, double io[]);
+
+/// @brief Perform a step of the connected component of a session, i.e., a
+/// call to ::update_conductance followed by the voltage stimulation.
+///
+/// @param[in, out] s The session.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs; the message of the error is saved in the session.
+int session_step(session* s, double io[]);
+
+/// @brief Destroy a session by freeing its workspaces. The network state is
+/// not destroyed.
+///
+/// @param[in, out] s The session to destroy.
+void destroy_session(session s);
+
+#endif /* SESSION_H */
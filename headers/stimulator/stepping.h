@@ -0,0 +1,242 @@
+/**
+ * @file stepping.h
+ *
+ * @brief Defines drivers coupling the voltage stimulation of a Nanowire
+ * Network with the update of its conductance over time.
+ *
+ * The usual simulation loop alternates a call to `voltage_stimulation` and
+ * one to `update_conductance`, advancing the time by TAU per iteration. Most
+ * of the simulated time is however quasi-static, and the conductance barely
+ * changes between consecutive iterations. The drivers defined here adapt the
+ * time step to the dynamics of the junctions, reducing the number of linear
+ * systems to solve.
+ *
+ * Under a constant stimulation, the equilibrium of the network can also be
+ * computed directly, as the state in which each junction has the conductance
+ * it relaxes to under its voltage drop (see ::equilibrium_conductance). It is
+ * the fixed point of the map that stimulates the network and relaxes the
+ * junctions for some steps at the resulting voltages; the fixed point
+ * iteration is accelerated with the Anderson mixing of the last iterates.
+ *
+ * Finally, a long stimulation protocol can be integrated in parallel in time
+ * with the Parareal algorithm: the protocol is split in time slices, whose
+ * initial states are predicted with a cheap coarse propagator (large time
+ * steps, possibly on a reduced network), then refined concurrently with the
+ * exact stepping, and corrected until they match the sequential trajectory.
+ *
+ * A step of a whole network (i.e., the update and stimulation of all its
+ * connected components) can instead be performed in a single parallel region
+ * (see ::network_step): each thread updates and stimulates a component at a
+ * time, so that the update of a component overlaps with the solution of
+ * another one, without a fork-join per component.
+ */
+#ifndef STEPPING_H
+#define STEPPING_H
+
+#include "device/network.h"
+#include "device/component.h"
+#include "interface/interface.h"
+#include "stimulator/mna.h"
+
+/// @brief Settings of the Parareal integration of a stimulation protocol.
+typedef struct
+{
+    int             slices_count;   ///< Number of time slices integrated in
+                                    ///< parallel.
+    int             coarse_ratio;   ///< Number of steps of the protocol
+                                    ///< covered by a step of the coarse
+                                    ///< propagator.
+    int             max_iterations; ///< Maximum number of Parareal
+                                    ///< iterations.
+    double          tolerance;      ///< Maximum change of the normalized
+                                    ///< conductance of a junction at the start
+                                    ///< of a slice between two iterations, at
+                                    ///< which the integration stops.
+    mna_settings    coarse;         ///< Settings of the MNA solver of the
+                                    ///< coarse propagator (e.g., with an
+                                    ///< approximate reduction of the CC).
+} parareal_settings;
+
+/// @brief Plan of the step of all the connected components of a Nanowire
+/// Network, computed once from the components and the interface.
+typedef struct
+{
+    int                     ccs_count;      ///< Number of connected
+                                            ///< components.
+    connected_component*    ccs;            ///< Connected components, sorted
+                                            ///< by decreasing size. Their
+                                            ///< junction indexes are shared
+                                            ///< with the original ones.
+    interface*              its;            ///< Part of the interface
+                                            ///< connected to each component.
+    int*                    ss;             ///< Start in s2i of the sources
+                                            ///< of each component.
+    int*                    s2i;            ///< Index in the interface of each
+                                            ///< source of each component.
+    int                     chunks_count;   ///< Number of chunks of the
+                                            ///< largest components.
+    connected_component*    chunks;         ///< Chunks of junctions of the
+                                            ///< components large enough to be
+                                            ///< updated by all the threads.
+} step_plan;
+
+/// @brief Stimulate a connected component with constant source voltages for
+/// a time interval, adapting the time step so that the normalized conductance
+/// of no junction changes more than a tolerance in a step (see
+/// ::conductance_step). Between two steps the voltage distribution is
+/// recomputed with ::voltage_stimulation_with.
+///
+/// @param[in, out] ns The Nanowire Network electrical state. At the end of the
+/// interval, it contains the updated conductances and the corresponding
+/// voltage distribution.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source during the whole
+/// interval, as output it contains the current drawn from that node at its
+/// end.
+/// @param[in] duration The time interval to simulate (in the same unit of
+/// TAU).
+/// @param[in] tolerance The maximum change of the normalized conductance of a
+/// junction in a step.
+/// @param[in] settings The settings of the MNA solver.
+/// @return The number of voltage stimulations performed, or -1 if an error
+/// occurs (e.g. if the sources/grounds/loads nanowires are not connected).
+int adaptive_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    double duration,
+    double tolerance,
+    const mna_settings settings
+);
+
+/// @brief Find the steady state of a connected component under constant source
+/// voltages, i.e., the state reached by ::adaptive_stimulation for an
+/// indefinite duration, by the Anderson-accelerated fixed point iteration on
+/// the conductance of the junctions. The current state is the initial guess
+/// (e.g., the steady state of a close stimulation).
+///
+/// @param[in, out] ns The Nanowire Network electrical state. At the end, it
+/// contains the steady conductances and the corresponding voltage
+/// distribution.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in, out] io An array with an entry for each source. As input
+/// parameter it contains the voltage applied to a source, as output it
+/// contains the current drawn from that node in the steady state.
+/// @param[in] tolerance The maximum distance of the normalized conductance of
+/// a junction from its equilibrium at the steady state.
+/// @param[in] max_iterations The maximum number of iterations.
+/// @param[in] settings The settings of the MNA solver.
+/// @return The number of voltage stimulations performed, or -1 if an error
+/// occurs (e.g. if the iteration does not converge).
+int steady_state(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    double tolerance,
+    int max_iterations,
+    const mna_settings settings
+);
+
+/// @brief Find the steady states of a connected component for a sequence of
+/// source voltages (e.g., to compute an I-V curve), by continuation: the
+/// steady state of each point is the initial guess of the next one, after a
+/// secant extrapolation from the previous two.
+///
+/// @param[in, out] ns The Nanowire Network electrical state. At the end, it
+/// contains the steady state of the last point.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in, out] ios A row-major matrix with a row for each point and an
+/// entry for each source. As input parameter it contains the voltages
+/// applied to the sources, as output the currents drawn at the steady state.
+/// @param[in] points_count The number of points of the sequence.
+/// @param[in] tolerance The maximum distance of the normalized conductance of
+/// a junction from its equilibrium at the steady state.
+/// @param[in] max_iterations The maximum number of iterations per point.
+/// @param[in] settings The settings of the MNA solver.
+/// @return The total number of voltage stimulations performed, or -1 if an
+/// error occurs.
+int steady_sweep(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    int points_count,
+    double tolerance,
+    int max_iterations,
+    const mna_settings settings
+);
+
+/// @brief Perform a stimulation protocol, i.e., a sequence of steps each made
+/// of a call to ::voltage_stimulation_with and one to ::update_conductance,
+/// by integrating its time slices in parallel with the Parareal algorithm.
+/// The result matches the sequential protocol within the tolerance, and is
+/// exact when the number of iterations reaches the number of slices.
+///
+/// @param[in, out] ns The Nanowire Network electrical state. At the end, it
+/// contains the state after the last step of the protocol.
+/// @param[in] cc The connected component of `ns` to stimulate.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @param[in, out] ios A row-major matrix with a row for each step and an
+/// entry for each source. As input parameter it contains the voltages applied
+/// to the sources, as output the currents drawn at each step.
+/// @param[in] steps The number of steps of the protocol.
+/// @param[in] settings The settings of the MNA solver of the exact stepping.
+/// @param[in] ps The settings of the Parareal integration.
+/// @return The number of Parareal iterations performed, or -1 if an error
+/// occurs.
+int parareal_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    int steps,
+    const mna_settings settings,
+    const parareal_settings ps
+);
+
+/// @brief Create the plan of the step of all the connected components of a
+/// Nanowire Network.
+///
+/// @param[in] ccs The connected components of the Nanowire Network. Their
+/// junction indexes must outlive the plan.
+/// @param[in] ccs_count The number of connected components.
+/// @param[in] it The interface of the Nanowire Network with the external
+/// world, including sources, grounds and loads.
+/// @return The plan of the step. It must be destroyed with
+/// `destroy_step_plan`.
+step_plan create_step_plan(
+    const connected_component ccs[],
+    int ccs_count,
+    const interface it
+);
+
+/// @brief Perform a step of a whole Nanowire Network, i.e., a call to
+/// ::update_conductance followed by one to ::voltage_stimulation for each of
+/// its connected components, in a single parallel region. The components
+/// not connected to any source are not solved, as their voltage is null.
+///
+/// @param[in, out] ns The Nanowire Network electrical state.
+/// @param[in] sp The plan of the step.
+/// @param[in, out] io An array with an entry for each source of the
+/// interface. As input parameter it contains the voltage applied to a source,
+/// as output it contains the current drawn from that node.
+/// @return 0 if the computation successfully terminates, -1 if an error
+/// occurs.
+int network_step(network_state ns, const step_plan sp, double io[]);
+
+/// @brief Destroy a step plan by freeing its pointers.
+///
+/// @param[in, out] sp The step plan to destroy.
+void destroy_step_plan(step_plan sp);
+
+#endif /* STEPPING_H */
@@ -0,0 +1,88 @@
+/**
+ * @file sweep.h
+ *
+ * @brief Defines an executor of parameter sweeps over datasheets, MEA
+ * configurations and stimulation protocols.
+ *
+ * A sweep simulates each combination (job) of a datasheet, a configuration of
+ * the electrodes of a MEA and a stimulation protocol. The topology of each
+ * datasheet is generated once and shared by all its jobs; the jobs are
+ * executed as tasks by a pool of threads sized to the machine, each one
+ * starting as soon as the topology of its datasheet is available, and idle
+ * threads taking the pending tasks.
+ *
+ * The results of each job are streamed to disk in the layout of the
+ * serializer (see serializer.h), as a device whose identifier is the index of
+ * the job: the network, the MEA and the interface are saved at the start of
+ * the job (with step 0), and the network state during the protocol. The
+ * currents drawn from the sources at every step are saved in a file named
+ * "io.nns" (see CURRENTS_FILE_NAME_FORMAT) holding the version of the format,
+ * the number of sources and, for each step executed, a row with the current
+ * of each source (in the order of the protocol inputs).
+ *
+ * A job that cannot write its results stops and is counted as failed, without
+ * terminating the other jobs.
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "device/datasheet.h"
+#include "interface/mea.h"
+
+/// @brief Stimulation protocol of the sources of a MEA.
+typedef struct
+{
+    int             steps;          ///< Number of steps of the protocol.
+    int             sources_count;  ///< Number of sources stimulated.
+    const double*   inputs;         ///< Row-major matrix with a row for each
+                                    ///< step and an entry for each source (in
+                                    ///< the order of the electrodes), with the
+                                    ///< voltage applied at that step.
+} protocol;
+
+/// @brief Parameter sweep over datasheets, MEA configurations and
+/// stimulation protocols.
+typedef struct
+{
+    int                 datasheets_count;   ///< Number of datasheets.
+    const datasheet*    dss;                ///< Datasheets of the devices.
+    int                 meas_count;         ///< Number of MEA configurations.
+    const MEA*          meas;               ///< Configurations of the MEA:
+                                            ///< only the connection type and
+                                            ///< load weight of the electrodes
+                                            ///< are used, as the MEA is
+                                            ///< connected to each device.
+    int                 protocols_count;    ///< Number of protocols.
+    const protocol*     protocols;          ///< Stimulation protocols. The
+                                            ///< sources of each protocol must
+                                            ///< be the ones of each MEA.
+    char*               path;               ///< Base path of the results.
+    int                 snapshot_period;    ///< Number of steps between two
+                                            ///< serialized states (the last
+                                            ///< one is always serialized); 0
+                                            ///< serializes only the last one.
+    int                 threads_count;      ///< Number of threads of the pool;
+                                            ///< 0 uses all the processors.
+} sweep;
+
+/// @brief Return the index of the job of a sweep, i.e., the identifier of
+/// the device in which its results are serialized.
+///
+/// @param[in] sw The sweep.
+/// @param[in] d The index of the datasheet.
+/// @param[in] m The index of the MEA configuration.
+/// @param[in] p The index of the protocol.
+/// @return The index of the job.
+int sweep_job(const sweep sw, int d, int m, int p);
+
+/// @brief Execute all the jobs of a parameter sweep. Each job stimulates all
+/// the connected components of its device at each step of its protocol (see
+/// ::network_step), saving the currents of its sources at every step and
+/// serializing its network state every snapshot period.
+///
+/// @param[in] sw The sweep to execute.
+/// @return 0 if all the jobs successfully terminate, -1 if the sweep is not
+/// valid or if any job fails (e.g., its results cannot be written).
+int run_sweep(const sweep sw);
+
+#endif /* SWEEP_H */
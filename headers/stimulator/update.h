@@ -1,7 +1,7 @@
 /**
  * @file update.h
  * 
- * @brief Defines the `update_conductance` function.
+ * @brief Defines the `update_conductance` function and its variants.
  * 
  * This file provides the declaration of the `update_conductance` function, 
  * which updates the conductance (or weights) of the nanowire junctions in 
@@ -11,7 +11,20 @@
  * component data structures.
  * 
  * The underlying model for this function was originally proposed by Enrique
- * Miranda.
+ * Miranda. At fixed voltages, the normalized conductance of a junction
+ * follows the affine recurrence:
+ * ```
+ *      g' = kp / kpd + kd / kpd * exp(-TAU * kpd) * g = a + b * g
+ * ```
+ * whose N-step solution has the closed form:
+ * ```
+ *      g_N = g* + b^N * (g_0 - g*)         with g* = a / (1 - b)
+ * ```
+ * This allows to advance the network through rest periods and warm-ups in a
+ * single pass over the junctions (see `advance_conductance`). A fractional
+ * number of steps N = dt / TAU interpolates the recurrence with the flow of
+ * the same exponential relaxation, allowing arbitrary time steps (see
+ * `update_conductance_dt`).
  */
 #ifndef UPDATE_H
 #define UPDATE_H
@@ -19,6 +32,53 @@
 #include "device/network.h"
 #include "util/components.h"
 
+/// @brief Schedule of the updates of the junctions of a Connected Component in
+/// a multi-rate integration. Each junction is updated every `periods[k]`
+/// steps (a power of two), chosen according to its rate of change: the
+/// junctions under a large voltage drop switch in few steps and are updated at
+/// every step, while the quiescent ones are updated rarely, advancing them by
+/// all the skipped steps at once.
+typedef struct
+{
+    int     js_count;           ///< Number of junctions in the CC.
+    int     step;               ///< Number of steps performed.
+    double  tolerance;          ///< Maximum change of the normalized
+                                ///< conductance of a junction between two of
+                                ///< its updates.
+    int     max_period;         ///< Maximum number of steps between two
+                                ///< updates of a junction.
+    double  voltage_tolerance;  ///< Change of the voltage drop of a junction
+                                ///< forcing its update before the end of its
+                                ///< period.
+    int*    periods;            ///< Steps between two updates of each
+                                ///< junction.
+    int*    lasts;              ///< Step of the last update of each junction.
+    double* drops;              ///< Voltage drop of each junction at its last
+                                ///< update.
+    long    updates_count;      ///< Number of junction updates performed.
+} multirate_schedule;
+
+/// @brief Cache of the update coefficients of the junctions of a Connected
+/// Component for an event-driven update. The coefficients of a junction (i.e.,
+/// the terms a = kp / kpd and b = kd / kpd * exp(-TAU * kpd) of its recurrence)
+/// are recomputed only when its voltage drop changes, otherwise the update is a
+/// multiply-add.
+typedef struct
+{
+    int     js_count;           ///< Number of junctions in the CC.
+    double  voltage_tolerance;  ///< Change of the voltage drop of a junction
+                                ///< forcing the computation of its
+                                ///< coefficients.
+    double* drops;              ///< Voltage drop of each junction at the
+                                ///< computation of its coefficients.
+    double* as;                 ///< Constant term of the recurrence of each
+                                ///< junction.
+    double* bs;                 ///< Decay factor of the recurrence of each
+                                ///< junction.
+    long    refreshes_count;    ///< Number of computations of the
+                                ///< coefficients performed.
+} update_cache;
+
 /// @brief Update the weight of the nanowires junctions (i.e., their
 /// conductance) according to the current stimulation (i.e., voltage
 /// distribution in the network). The only weights updated are the ones
@@ -32,4 +92,157 @@
 /// update.
 void update_conductance(network_state ns, connected_component cc);
 
+/// @brief Return the weight of a junction after a step of
+/// ::update_conductance, i.e., the computation it performs on each junction.
+/// The result is bitwise equal to the one of ::update_conductance, so that
+/// the step can be replayed from a stored state (see trajectory.h).
+///
+/// @param[in] Y The weight of the junction.
+/// @param[in] ΔV The absolute voltage drop on the junction.
+/// @return The weight of the junction after the step.
+double updated_conductance(double Y, double ΔV);
+
+/// @brief Advance the weight of the nanowires junctions by several steps of
+/// `update_conductance` at once, assuming that the voltage distribution in the
+/// network does not change in the meantime (e.g., during a rest period with no
+/// stimulation). The cost is independent of the number of steps.
+/// 
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in, out] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in] steps The number of update steps to perform.
+void advance_conductance(network_state ns, connected_component cc, int steps);
+
+/// @brief Update the weight of the nanowires junctions over an arbitrary time
+/// interval at fixed voltages. An interval of TAU is equivalent to a call to
+/// `update_conductance`, and an interval of N * TAU to N calls.
+/// 
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in, out] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in] dt The time interval of the update (in the same unit of TAU).
+void update_conductance_dt(network_state ns, connected_component cc, double dt);
+
+/// @brief Calculate the largest time step for which the normalized
+/// conductance (i.e., in [0, 1]) of no junction changes more than a tolerance
+/// at the current voltages.
+/// 
+/// @param[in] ns The Nanowire Network electrical state that contains the
+/// junctions to check.
+/// @param[in] cc The Connected Component specifying the junctions to check.
+/// @param[in] tolerance The maximum change of the normalized conductance.
+/// @return The largest time step (in the same unit of TAU), or INFINITY if no
+/// junction can change more than the tolerance.
+double conductance_step(
+    const network_state ns,
+    const connected_component cc,
+    double tolerance
+);
+
+/// @brief Calculate the conductance that each junction of a Connected
+/// Component reaches if the current voltages are kept indefinitely, i.e., the
+/// fixed point of the update recurrence.
+/// 
+/// @param[in] ns The Nanowire Network electrical state that contains the
+/// junctions.
+/// @param[in] cc The Connected Component specifying the junctions.
+/// @param[out] Ys The equilibrium conductance of each junction of the CC.
+void equilibrium_conductance(
+    const network_state ns,
+    const connected_component cc,
+    double Ys[]
+);
+
+/// @brief Create the multi-rate schedule of the junctions of a Connected
+/// Component. At the first step, all the junctions are updated and
+/// classified.
+/// 
+/// @param[in] cc The Connected Component whose junctions to schedule.
+/// @param[in] tolerance The maximum change of the normalized conductance of a
+/// junction between two of its updates.
+/// @param[in] max_period The maximum number of steps between two updates of a
+/// junction.
+/// @param[in] voltage_tolerance The change of the voltage drop of a junction
+/// forcing its update (and reclassification) before the end of its period.
+/// @return The multi-rate schedule. It must be destroyed with
+/// `destroy_schedule`.
+multirate_schedule create_schedule(
+    const connected_component cc,
+    double tolerance,
+    int max_period,
+    double voltage_tolerance
+);
+
+/// @brief Perform a step of `update_conductance` on the junctions whose period
+/// ended (or whose voltage drop changed), advancing them by all the steps
+/// elapsed since their last update. The conductance of the other junctions is
+/// not modified until their next update.
+/// 
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in, out] ms The multi-rate schedule of the junctions.
+void multirate_update(
+    network_state ns,
+    const connected_component cc,
+    multirate_schedule* ms
+);
+
+/// @brief Advance all the junctions of a multi-rate schedule to its current
+/// step (e.g., before saving or measuring the network state).
+/// 
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in, out] ms The multi-rate schedule of the junctions.
+void flush_schedule(
+    network_state ns,
+    const connected_component cc,
+    multirate_schedule* ms
+);
+
+/// @brief Destroy a multi-rate schedule by freeing its pointers.
+/// 
+/// @param[in, out] ms The multi-rate schedule to destroy.
+void destroy_schedule(multirate_schedule ms);
+
+/// @brief Create the cache of the update coefficients of the junctions of a
+/// Connected Component. The coefficients of all the junctions are computed at
+/// the first update.
+/// 
+/// @param[in] cc The Connected Component whose junctions to cache.
+/// @param[in] voltage_tolerance The change of the voltage drop of a junction
+/// forcing the computation of its coefficients. With a tolerance of 0, the
+/// update is the same of `update_conductance`.
+/// @return The cache of the update coefficients. It must be destroyed with
+/// `destroy_update_cache`.
+update_cache create_update_cache(
+    const connected_component cc,
+    double voltage_tolerance
+);
+
+/// @brief Perform a step of `update_conductance` reusing the cached
+/// coefficients of the junctions whose voltage drop did not change more than
+/// the tolerance.
+/// 
+/// @param[in, out] ns The Nanowire Network electrical state that contains
+/// the junctions to be updated.
+/// @param[in] cc The Connected Component specifying the junctions to be
+/// update.
+/// @param[in, out] uc The cache of the update coefficients of the junctions.
+void cached_update(
+    network_state ns,
+    const connected_component cc,
+    update_cache* uc
+);
+
+/// @brief Destroy a cache of update coefficients by freeing its pointers.
+/// 
+/// @param[in, out] uc The cache to destroy.
+void destroy_update_cache(update_cache uc);
+
 #endif /* UPDATE_H */
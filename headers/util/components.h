@@ -72,4 +72,24 @@ connected_component* split_components(
     int cc_count
 );
 
+/// @brief Construe the adjacency lists of the nanowires of a connected
+/// component in compressed form. The neighbours of the nanowire `i` are
+/// `Aj[Ap[i]] .. Aj[Ap[i + 1] - 1]`, and they are reached through the
+/// junctions `Ak[Ap[i]] .. Ak[Ap[i + 1] - 1]`.
+/// 
+/// @param[in] cc The connected component whose adjacency lists to construe.
+/// @param[out] Ap An array of length `cc.ws_count + 1` containing the start
+/// of the neighbours of each nanowire in Aj and Ak.
+/// @param[out] Aj An array of length `2 * cc.js_count` containing the index
+/// of the neighbours of each nanowire (relative to the CC).
+/// @param[out] Ak An array of length `2 * cc.js_count` containing the index
+/// of the junction connecting each nanowire with its neighbours (relative to
+/// the CC). It can be NULL if not needed.
+void construe_adjacency_lists(
+    const connected_component cc,
+    int Ap[],
+    int Aj[],
+    int Ak[]
+);
+
 #endif /* COMPONENTS_H */
@@ -10,6 +10,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/// @brief Maximum length of an error message saved in a buffer (see
+/// ::redirect_errors).
+#define ERROR_LENGTH 256
+
 /// @brief Macro to perform condition-assertion and exit with the specific
 /// error-code in case of error. The macro expects a boolean condition as
 /// first input, a possible error code as the second and a message with
@@ -40,9 +44,26 @@
     ({                                      \
         if (! (EVAL))                       \
         {                                   \
-            printf(__VA_ARGS__);            \
+            report_error(__VA_ARGS__);      \
             return ERROR_CODE;              \
         }                                   \
     })
 
+/// @brief Report the message of an unexpected condition: by default it is
+/// printed on the standard output, otherwise it is saved in the buffer of the
+/// calling thread (see ::redirect_errors).
+///
+/// @param[in] format The formatted error message.
+/// @param[in] ... The referenced variables.
+void report_error(const char* format, ...);
+
+/// @brief Redirect the messages reported by the calling thread to a buffer
+/// of ERROR_LENGTH characters, in place of the standard output. Each message
+/// overwrites the previous one.
+///
+/// @param[in] buffer The buffer receiving the messages, or NULL to print them
+/// on the standard output.
+/// @return The buffer previously used by the thread (NULL if none).
+char* redirect_errors(char* buffer);
+
 #endif /* ERRORS_H */
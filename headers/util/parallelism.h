@@ -0,0 +1,87 @@
+/**
+ * @file parallelism.h
+ *
+ * @brief Defines the thresholds under which the parallel loops of the library
+ * are executed serially.
+ *
+ * Opening an OpenMP parallel region has a fixed cost that exceeds the work of
+ * a loop over a few hundred junctions. Each parallelized kernel is thus
+ * executed by a team of threads only if its work, measured in the units of
+ * the kernel (e.g., junctions), reaches a threshold. The costs are calibrated
+ * once, at the first use, by a small probe that measures a parallel region
+ * with the threads of the caller (e.g., within the budget of a session) and a
+ * unit of work of each kernel. The threshold is
+ * computed at each query from these costs and from the number of threads of
+ * a parallel region of the caller (e.g., the budget of a session), so that
+ * callers with different teams do not share the same thresholds. Otherwise,
+ * they can be set through `set_parallel_threshold`.
+ */
+#ifndef PARALLELISM_H
+#define PARALLELISM_H
+
+/// @brief Kernels whose parallelism depends on a threshold.
+typedef enum
+{
+    UPDATE_GRAIN,       ///< ::update_conductance and the other loops
+                        ///< evaluating the update of each junction (e.g.,
+                        ///< ::fused_update, ::vectorized_update), in
+                        ///< junctions.
+    CIRCUIT_GRAIN,      ///< ::construe_circuit and the other loops copying
+                        ///< or scattering a value per unit (e.g.,
+                        ///< ::refill_pattern, ::expand_state), in units.
+    MEA_GRAIN,          ///< ::connect_MEA, in electrode to nanowire distances.
+    ADJACENCY_GRAIN,    ///< ::construe_adjacency_matrix, in junctions.
+    GRAINS_COUNT        ///< Number of kernels.
+} grain_t;
+
+/// @brief Result of the calibration of the parallelism thresholds.
+typedef struct
+{
+    int     threads_count;              ///< Number of threads of the
+                                        ///< parallel region measured by the
+                                        ///< probe (i.e., the threads of
+                                        ///< the calibrating caller).
+    double  fork_join_time;             ///< Cost of a parallel region (in
+                                        ///< seconds).
+    double  unit_times[GRAINS_COUNT];   ///< Serial cost of a unit of work of
+                                        ///< each kernel (in seconds), or 0 if
+                                        ///< its threshold has been set.
+    int     thresholds[GRAINS_COUNT];   ///< Minimum work of each kernel to be
+                                        ///< executed in parallel by the team
+                                        ///< of the caller.
+} calibration;
+
+/// @brief Measure the cost of a parallel region and of a unit of work of each
+/// kernel, from which the thresholds at which the parallel execution of a
+/// kernel becomes convenient are computed. Thresholds previously set are
+/// overwritten.
+///
+/// @note It must not be called inside a parallel region.
+///
+/// @return The result of the calibration.
+calibration calibrate_thresholds(void);
+
+/// @brief Return the calibration in use, performing it if needed.
+///
+/// @return The current calibration.
+calibration current_calibration(void);
+
+/// @brief Return the minimum work of a kernel to be executed in parallel by
+/// a parallel region of the caller, given its number of threads (INT_MAX for
+/// a single thread). The first call outside a parallel region performs the
+/// calibration, if the threshold has not been set; until then, a default
+/// threshold is returned.
+///
+/// @param[in] grain The kernel.
+/// @return The threshold of the kernel.
+int parallel_threshold(grain_t grain);
+
+/// @brief Set the minimum work of a kernel to be executed in parallel,
+/// skipping the calibration. E.g., 0 always parallelizes the kernel, while
+/// INT_MAX always executes it serially.
+///
+/// @param[in] grain The kernel.
+/// @param[in] threshold The new threshold of the kernel.
+void set_parallel_threshold(grain_t grain, int threshold);
+
+#endif /* PARALLELISM_H */
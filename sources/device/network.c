@@ -3,6 +3,7 @@
 
 #include "device/network.h"
 #include "util/components.h"
+#include "util/parallelism.h"
 #include "util/tensors.h"
 #include "util/wires.h"
 #include "config.h"
@@ -33,7 +34,7 @@ network_state construe_circuit(const datasheet ds, const network_topology nt)
     double* V = zeros_vector(double, ds.wires_count);
 
     // fill the Ys array with the minimum conductance weight
-    #pragma omp parallel for
+    #pragma omp parallel for if(nt.js_count >= parallel_threshold(CIRCUIT_GRAIN))
     for (int i = 0; i < nt.js_count; i++)
     {
         Y[i] = Y_MIN;
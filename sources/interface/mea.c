@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "interface/mea.h"
+#include "util/parallelism.h"
 #include "util/tensors.h"
 
 MEA connect_MEA(const datasheet ds, const network_topology nt)
@@ -37,7 +38,7 @@ MEA connect_MEA(const datasheet ds, const network_topology nt)
 
     // map the electrodes index to the index of the
     // nearest nanowire (considering the centroid)
-    #pragma omp parallel for
+    #pragma omp parallel for if(MEA_ELECTRODES * ds.wires_count >= parallel_threshold(MEA_GRAIN))
     for (int i = 0; i < MEA_ELECTRODES; i++)
     {
         double min_distance = DBL_MAX; 
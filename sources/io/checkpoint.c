@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "io/checkpoint.h"
+#include "io/serializer.h"
+#include "util/errors.h"
+#include "util/tensors.h"
+
+// body of the background thread: write the queued states in order, until
+// the writer is stopped and the queue is empty
+static void* write_checkpoints(void* argument);
+
+// write a state with the layout of `serialize_state', reporting the errors
+// instead of terminating the process
+static int write_state(const checkpoint_writer* cw, const network_state ns, int step);
+
+int create_checkpoint_writer(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int depth,
+    checkpoint_writer* cw
+)
+{
+    depth = depth < 1 ? 1 : depth;
+    size_t size = (size_t)nt.js_count + ds.wires_count;
+
+    *cw = (checkpoint_writer){
+        .ds = ds, .nt = nt, .path = path, .id = id,
+        .depth = depth,
+        .buffers = vector(double, depth * size + 1),
+        .steps = vector(int, depth),
+        .ready = zeros_vector(bool, depth)
+    };
+    pthread_mutex_init(&cw->lock, NULL);
+    pthread_cond_init(&cw->changed, NULL);
+
+    int result = pthread_create(&cw->thread, NULL, write_checkpoints, cw);
+    if (result != 0)
+    {
+        pthread_mutex_destroy(&cw->lock);
+        pthread_cond_destroy(&cw->changed);
+        free(cw->buffers);
+        free(cw->steps);
+        free(cw->ready);
+    }
+    requires(result == 0, -1, "The thread of the checkpoint writer cannot be started!\n");
+
+    return 0;
+}
+
+void checkpoint_state(checkpoint_writer* cw, const network_state ns, int step)
+{
+    size_t size = (size_t)cw->nt.js_count + cw->ds.wires_count;
+
+    // wait for a free buffer and reserve it
+    pthread_mutex_lock(&cw->lock);
+    while (cw->count == cw->depth)
+    {
+        pthread_cond_wait(&cw->changed, &cw->lock);
+    }
+    int b = (cw->head + cw->count) % cw->depth;
+    cw->count++;
+    pthread_mutex_unlock(&cw->lock);
+
+    // the reserved buffer is not accessed by the other threads until it is
+    // ready: the copy is performed without holding the lock
+    double* buffer = cw->buffers + b * size;
+    memcpy(buffer, ns.Ys, cw->nt.js_count * sizeof(double));
+    memcpy(buffer + cw->nt.js_count, ns.Vs, cw->ds.wires_count * sizeof(double));
+    cw->steps[b] = step;
+
+    pthread_mutex_lock(&cw->lock);
+    cw->ready[b] = true;
+    pthread_cond_broadcast(&cw->changed);
+    pthread_mutex_unlock(&cw->lock);
+}
+
+int flush_checkpoints(checkpoint_writer* cw)
+{
+    pthread_mutex_lock(&cw->lock);
+    while (cw->count > 0)
+    {
+        pthread_cond_wait(&cw->changed, &cw->lock);
+    }
+    int failed = cw->failed;
+    cw->failed = 0;
+    pthread_mutex_unlock(&cw->lock);
+
+    requires(failed == 0, -1, "%d states of the checkpoint writer could not be written!\n", failed);
+
+    return 0;
+}
+
+int destroy_checkpoint_writer(checkpoint_writer* cw)
+{
+    pthread_mutex_lock(&cw->lock);
+    cw->stopping = true;
+    pthread_cond_broadcast(&cw->changed);
+    pthread_mutex_unlock(&cw->lock);
+
+    pthread_join(cw->thread, NULL);
+
+    int failed = cw->failed;
+    pthread_mutex_destroy(&cw->lock);
+    pthread_cond_destroy(&cw->changed);
+    free(cw->buffers);
+    free(cw->steps);
+    free(cw->ready);
+
+    requires(failed == 0, -1, "%d states of the checkpoint writer could not be written!\n", failed);
+
+    return 0;
+}
+
+static void* write_checkpoints(void* argument)
+{
+    checkpoint_writer* cw = argument;
+    size_t size = (size_t)cw->nt.js_count + cw->ds.wires_count;
+
+    pthread_mutex_lock(&cw->lock);
+    while (true)
+    {
+        // a reserved buffer is written only when it is ready, so that the
+        // states are written in the order of the reservations
+        while (!(cw->count > 0 && cw->ready[cw->head]) && !(cw->count == 0 && cw->stopping))
+        {
+            pthread_cond_wait(&cw->changed, &cw->lock);
+        }
+        if (cw->count == 0)
+        {
+            break;
+        }
+
+        // the head buffer is not modified until it is released
+        double* buffer = cw->buffers + cw->head * size;
+        int step = cw->steps[cw->head];
+        pthread_mutex_unlock(&cw->lock);
+
+        network_state ns = { buffer, buffer + cw->nt.js_count };
+        int result = write_state(cw, ns, step);
+
+        // release the buffer
+        pthread_mutex_lock(&cw->lock);
+        cw->failed += result != 0;
+        cw->ready[cw->head] = false;
+        cw->head = (cw->head + 1) % cw->depth;
+        cw->count--;
+        pthread_cond_broadcast(&cw->changed);
+    }
+    pthread_mutex_unlock(&cw->lock);
+
+    return NULL;
+}
+
+static int write_state(const checkpoint_writer* cw, const network_state ns, int step)
+{
+    FILE* file = create_file(STATE_FILE_NAME_FORMAT, cw->path, cw->id, step);
+    requires(file != NULL, -1, "The state %d cannot be written!\n", step);
+
+    // write the junctions weight and the nodes voltage after the version
+    bool written = fwrite(ns.Ys, sizeof(double), cw->nt.js_count, file) == (size_t)cw->nt.js_count;
+    written = written && fwrite(ns.Vs, sizeof(double), cw->ds.wires_count, file) == (size_t)cw->ds.wires_count;
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The state %d cannot be written!\n", step);
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "io/codec.h"
+#include "util/errors.h"
+
+// longest run of zero words encoded by a token
+#define MAX_RUN 128
+
+// bits of the probabilities of the range coder, and speed of their adaptation
+#define PROBABILITY_BITS 11
+#define ADAPTATION_SHIFT 5
+
+// contexts of the coded bytes: a token after a run or after a word with z
+// leading zero bytes, and a byte b of a word with z leading zero bytes
+#define TOKEN_CONTEXTS 9
+#define CONTEXTS (TOKEN_CONTEXTS + 8 * 8)
+
+// maximum number of bytes emitted for a word, when each of its bits is the
+// least probable one
+#define MAX_WORD_CODE 64
+
+// adaptive probabilities of the bits of a byte in a context, indexed by the
+// node of the binary tree of the byte (from 1 to 255)
+typedef uint16_t byte_model[256];
+
+// binary range encoder, emitting the bytes of the encoding in order
+typedef struct
+{
+    uint64_t        low;        // lower end of the interval, with its carry
+    uint32_t        range;      // width of the interval
+    unsigned char   cache;      // byte waiting for a possible carry
+    size_t          pending;    // number of bytes waiting for the carry
+    unsigned char*  out;        // the encoding
+    size_t          n;          // number of bytes emitted
+} range_encoder;
+
+// binary range decoder, consuming the bytes of an encoding in order
+typedef struct
+{
+    uint32_t                code;       // offset of the value in the interval
+    uint32_t                range;      // width of the interval
+    const unsigned char*    in;         // the encoding
+    size_t                  size;       // number of bytes of the encoding
+    size_t                  n;          // number of bytes consumed
+    bool                    overrun;    // whether the encoding ended early
+} range_decoder;
+
+// XOR of a double with its prediction: the corresponding previous one, or
+// the preceding one of the array if there is no previous array
+static uint64_t delta(const double xs[], const double previous[], int i);
+
+// bits of the prediction of a double: the corresponding previous one, or the
+// preceding one of the array (zero for the first one)
+static uint64_t prediction(const double xs[], const double previous[], int i);
+
+// set the probabilities of all the contexts to one half
+static void reset_models(byte_model models[]);
+
+// encode a byte with the probabilities of its context
+static void encode_byte(range_encoder* re, byte_model model, unsigned char byte);
+
+// emit the byte of the encoder leaving the interval, propagating the carry
+static void shift_low(range_encoder* re);
+
+// decode a byte with the probabilities of its context
+static unsigned char decode_byte(range_decoder* rd, byte_model model);
+
+// consume the next byte of the encoding, or zero if it is over
+static unsigned char next_byte(range_decoder* rd);
+
+size_t encoded_bound(int count)
+{
+    // the encoding stops as soon as it exceeds the raw values, within the
+    // code of a word and the flush of the encoder
+    return (size_t)count * sizeof(double) + 2 * MAX_WORD_CODE;
+}
+
+size_t encode_delta(
+    const double xs[],
+    const double previous[],
+    int count,
+    unsigned char out[]
+)
+{
+    byte_model models[CONTEXTS];
+    reset_models(models);
+
+    range_encoder re = { .range = UINT32_MAX, .pending = 1, .out = out };
+    size_t raw = (size_t)count * sizeof(double);
+
+    int i = 0;
+    int context = 0;
+    while (i < count && re.n + re.pending < raw)
+    {
+        uint64_t x = delta(xs, previous, i);
+
+        // encode the run of unchanged values starting at i
+        if (x == 0)
+        {
+            int run = 1;
+            while (i + run < count && run < MAX_RUN && delta(xs, previous, i + run) == 0)
+            {
+                run++;
+            }
+
+            encode_byte(&re, models[context], 0x80 | (run - 1));
+            context = 0;
+            i += run;
+            continue;
+        }
+
+        // encode the bytes following the leading zero ones
+        int zeros = __builtin_clzll(x) / 8;
+        encode_byte(&re, models[context], zeros);
+        for (int b = 0; b < 8 - zeros; b++)
+        {
+            encode_byte(&re, models[TOKEN_CONTEXTS + 8 * zeros + b], x >> (8 * b));
+        }
+        context = 1 + zeros;
+        i++;
+    }
+
+    // flush the interval, if all the values are encoded
+    for (int b = 0; b < 5 && i == count; b++)
+    {
+        shift_low(&re);
+    }
+
+    // store the raw values if the encoding does not make them smaller: a raw
+    // encoding is recognized by its size
+    if (i < count || re.n >= raw)
+    {
+        memcpy(out, xs, raw);
+        re.n = raw;
+    }
+
+    return re.n;
+}
+
+int decode_delta(
+    const unsigned char in[],
+    size_t size,
+    const double previous[],
+    int count,
+    double xs[]
+)
+{
+    // the raw values, stored when the encoding is not smaller
+    if (size == (size_t)count * sizeof(double))
+    {
+        memcpy(xs, in, size);
+
+        return 0;
+    }
+
+    byte_model models[CONTEXTS];
+    reset_models(models);
+
+    // the first byte of the encoding is the empty carry of the encoder
+    range_decoder rd = { .range = UINT32_MAX, .in = in, .size = size };
+    for (int b = 0; b < 5; b++)
+    {
+        rd.code = rd.code << 8 | next_byte(&rd);
+    }
+
+    int i = 0;
+    int context = 0;
+    while (i < count && !rd.overrun)
+    {
+        unsigned char token = decode_byte(&rd, models[context]);
+
+        // a run of unchanged values
+        if (token & 0x80)
+        {
+            int run = (token & 0x7f) + 1;
+            requires(i + run <= count, -1, "The encoded run exceeds the array!\n");
+
+            for (int r = 0; r < run; r++, i++)
+            {
+                uint64_t bits = prediction(xs, previous, i);
+                memcpy(xs + i, &bits, sizeof(double));
+            }
+            context = 0;
+            continue;
+        }
+
+        // a changed value, with its non-zero bytes
+        requires(token < 8, -1, "The encoded value is malformed!\n");
+
+        uint64_t x = 0;
+        for (int b = 0; b < 8 - token; b++)
+        {
+            x |= (uint64_t)decode_byte(&rd, models[TOKEN_CONTEXTS + 8 * token + b]) << (8 * b);
+        }
+        context = 1 + token;
+
+        uint64_t bits = prediction(xs, previous, i) ^ x;
+        memcpy(xs + i++, &bits, sizeof(double));
+    }
+    requires(!rd.overrun && rd.n == size && i == count, -1, "The encoding does not match the array!\n");
+
+    return 0;
+}
+
+static uint64_t delta(const double xs[], const double previous[], int i)
+{
+    uint64_t x;
+    memcpy(&x, xs + i, sizeof(uint64_t));
+
+    return x ^ prediction(xs, previous, i);
+}
+
+static uint64_t prediction(const double xs[], const double previous[], int i)
+{
+    uint64_t p = 0;
+    if (previous != NULL)
+    {
+        memcpy(&p, previous + i, sizeof(uint64_t));
+    }
+    else if (i > 0)
+    {
+        memcpy(&p, xs + i - 1, sizeof(uint64_t));
+    }
+
+    return p;
+}
+
+static void reset_models(byte_model models[])
+{
+    for (int c = 0; c < CONTEXTS; c++)
+    {
+        for (int m = 0; m < 256; m++)
+        {
+            models[c][m] = 1 << (PROBABILITY_BITS - 1);
+        }
+    }
+}
+
+static void encode_byte(range_encoder* re, byte_model model, unsigned char byte)
+{
+    // encode the bits from the most significant one, each with the
+    // probability of its prefix
+    for (int m = 1, b = 7; b >= 0; b--)
+    {
+        int bit = byte >> b & 1;
+        uint32_t bound = (re->range >> PROBABILITY_BITS) * model[m];
+        if (bit == 0)
+        {
+            re->range = bound;
+            model[m] += ((1 << PROBABILITY_BITS) - model[m]) >> ADAPTATION_SHIFT;
+        }
+        else
+        {
+            re->low += bound;
+            re->range -= bound;
+            model[m] -= model[m] >> ADAPTATION_SHIFT;
+        }
+        m = 2 * m + bit;
+
+        // keep the interval wider than 2^24
+        while (re->range < 1u << 24)
+        {
+            re->range <<= 8;
+            shift_low(re);
+        }
+    }
+}
+
+static void shift_low(range_encoder* re)
+{
+    // the top byte is final unless a carry can still propagate into it
+    if ((uint32_t)re->low < 0xff000000u || re->low >> 32 != 0)
+    {
+        unsigned char carry = re->low >> 32;
+        unsigned char byte = re->cache;
+        for (; re->pending > 0; re->pending--)
+        {
+            re->out[re->n++] = byte + carry;
+            byte = 0xff;
+        }
+        re->cache = re->low >> 24;
+    }
+    re->pending++;
+    re->low = (re->low & 0x00ffffffu) << 8;
+}
+
+static unsigned char decode_byte(range_decoder* rd, byte_model model)
+{
+    int m = 1;
+    for (int b = 7; b >= 0; b--)
+    {
+        uint32_t bound = (rd->range >> PROBABILITY_BITS) * model[m];
+        if (rd->code < bound)
+        {
+            rd->range = bound;
+            model[m] += ((1 << PROBABILITY_BITS) - model[m]) >> ADAPTATION_SHIFT;
+            m = 2 * m;
+        }
+        else
+        {
+            rd->code -= bound;
+            rd->range -= bound;
+            model[m] -= model[m] >> ADAPTATION_SHIFT;
+            m = 2 * m + 1;
+        }
+
+        while (rd->range < 1u << 24)
+        {
+            rd->range <<= 8;
+            rd->code = rd->code << 8 | next_byte(rd);
+        }
+    }
+
+    return m & 0xff;
+}
+
+static unsigned char next_byte(range_decoder* rd)
+{
+    rd->overrun = rd->overrun || rd->n == rd->size;
+
+    return rd->overrun ? 0 : rd->in[rd->n++];
+}
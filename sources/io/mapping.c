@@ -0,0 +1,142 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "io/mapping.h"
+#include "io/serializer.h"
+#include "util/errors.h"
+
+extern const int VERSION_NUMBER;
+
+// alignment of the sections of the file
+#define SECTION_ALIGNMENT 64
+
+// round an offset up to the alignment of the sections
+#define ALIGN_SECTION(OFFSET) \
+    (((OFFSET) + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT)
+
+// header of the file, as laid out in memory
+typedef struct
+{
+    int         version;
+    int         wires_count;
+    int         js_count;
+    int         package_size;
+    int         generation_seed;
+    int         wire_size;
+    int         junction_size;
+    int         padding;
+    double      length_mean;
+    double      length_std_dev;
+    long long   ws_offset;
+    long long   js_offset;
+} mapped_header;
+
+// write zeros up to an offset of the file
+static void pad_file(FILE* file, long long offset);
+
+void serialize_mapped_network(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id
+)
+{
+    long long ws_offset = ALIGN_SECTION((long long)sizeof(mapped_header));
+    long long js_offset = ALIGN_SECTION(ws_offset + ds.wires_count * (long long)sizeof(wire));
+
+    mapped_header header = {
+        .version = VERSION_NUMBER,
+        .wires_count = ds.wires_count,
+        .js_count = nt.js_count,
+        .package_size = ds.package_size,
+        .generation_seed = ds.generation_seed,
+        .wire_size = sizeof(wire),
+        .junction_size = sizeof(junction),
+        .length_mean = ds.length_mean,
+        .length_std_dev = ds.length_std_dev,
+        .ws_offset = ws_offset,
+        .js_offset = js_offset
+    };
+
+    // create and open folder and file: the version is written by `new_file'
+    FILE* file = new_file(MAPPED_NETWORK_FILE_NAME_FORMAT, path, id, -1);
+    fwrite((char*)&header + sizeof(int), sizeof(mapped_header) - sizeof(int), 1, file);
+
+    // write the aligned sections
+    pad_file(file, ws_offset);
+    fwrite(nt.Ws, sizeof(wire), ds.wires_count, file);
+    pad_file(file, js_offset);
+    fwrite(nt.Js, sizeof(junction), nt.js_count, file);
+
+    fclose(file);
+}
+
+int map_network(char* path, int id, mapped_network* mn)
+{
+    char name[100];
+    snprintf(name, 100, MAPPED_NETWORK_FILE_NAME_FORMAT, path, id);
+
+    int descriptor = open(name, O_RDONLY);
+    requires(descriptor >= 0, -1, "Impossible to open file: %s for reading operations\n", name);
+
+    struct stat status;
+    bool valid = fstat(descriptor, &status) == 0 && status.st_size >= (off_t)sizeof(mapped_header);
+    void* address = valid ? mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+
+    // the mapping remains valid after closing the descriptor
+    close(descriptor);
+    requires(address != MAP_FAILED, -1, "The file %s cannot be mapped\n", name);
+
+    // check that the file has the layout of this build
+    const mapped_header* header = address;
+    long long size = status.st_size;
+    valid = header->version == VERSION_NUMBER;
+    valid = valid && header->wire_size == (int)sizeof(wire) && header->junction_size == (int)sizeof(junction);
+    valid = valid && header->wires_count >= 0 && header->js_count >= 0;
+    valid = valid && header->ws_offset % SECTION_ALIGNMENT == 0 && header->js_offset % SECTION_ALIGNMENT == 0;
+    valid = valid && header->ws_offset >= (long long)sizeof(mapped_header);
+    valid = valid && header->ws_offset + header->wires_count * (long long)sizeof(wire) <= header->js_offset;
+    valid = valid && header->js_offset + header->js_count * (long long)sizeof(junction) <= size;
+    if (!valid)
+    {
+        munmap(address, status.st_size);
+    }
+    requires(valid, -1, "The file %s is not a mapped network of this version\n", name);
+
+    *mn = (mapped_network){
+        .ds = {
+            .wires_count = header->wires_count,
+            .length_mean = header->length_mean,
+            .length_std_dev = header->length_std_dev,
+            .package_size = header->package_size,
+            .generation_seed = header->generation_seed
+        },
+        .nt = {
+            .Ws = (wire*)((char*)address + header->ws_offset),
+            .js_count = header->js_count,
+            .Js = (junction*)((char*)address + header->js_offset)
+        },
+        .address = address,
+        .size = status.st_size
+    };
+
+    return 0;
+}
+
+void unmap_network(mapped_network mn)
+{
+    munmap(mn.address, mn.size);
+}
+
+static void pad_file(FILE* file, long long offset)
+{
+    static const char zeros[SECTION_ALIGNMENT];
+
+    long long position = ftell(file);
+    fwrite(zeros, sizeof(char), offset - position, file);
+}
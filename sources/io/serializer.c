@@ -1,3 +1,4 @@
+#include <stdbool.h>
 #include <stdio.h>
 #include <sys/stat.h>
 
@@ -8,11 +9,7 @@
 
 const int VERSION_NUMBER = 1;
 
-// create and open a file with index `e_id' in a folder with index `nn_id'; if
-// the folder/file do not exist, create the folder/path/file
-FILE* new_file(char* file_type, char* path, int nn_id, int e_id);
-
-void serialize_network(
+int serialize_network(
     const datasheet ds,
     const network_topology nt,
     char* path,
@@ -20,26 +17,31 @@ void serialize_network(
 )
 {
     // create and open folder and file of the specific format
-    FILE* file = new_file(NETWORK_FILE_NAME_FORMAT, path, id, -1);
+    FILE* file = create_file(NETWORK_FILE_NAME_FORMAT, path, id, -1);
+    requires(file != NULL, -1, "The network %d cannot be serialized!\n", id);
 
     // DATASHEET WRITING
 
-    fwrite(&ds.wires_count,     sizeof(int),    1, file);
-    fwrite(&ds.length_mean,     sizeof(double), 1, file);
-    fwrite(&ds.length_std_dev,  sizeof(double), 1, file);
-    fwrite(&ds.package_size,    sizeof(int),    1, file);
-    fwrite(&ds.generation_seed, sizeof(int),    1, file);
+    bool written = true;
+    written = written && fwrite(&ds.wires_count,     sizeof(int),    1, file) == 1;
+    written = written && fwrite(&ds.length_mean,     sizeof(double), 1, file) == 1;
+    written = written && fwrite(&ds.length_std_dev,  sizeof(double), 1, file) == 1;
+    written = written && fwrite(&ds.package_size,    sizeof(int),    1, file) == 1;
+    written = written && fwrite(&ds.generation_seed, sizeof(int),    1, file) == 1;
 
     // TOPOLOGY WRITING
 
-    fwrite(&nt.js_count, sizeof(int),      1,              file);
-    fwrite(nt.Ws,        sizeof(wire),     ds.wires_count, file);
-    fwrite(nt.Js,        sizeof(junction), nt.js_count,    file);
+    written = written && fwrite(&nt.js_count, sizeof(int),      1,              file) == 1;
+    written = written && fwrite(nt.Ws,        sizeof(wire),     ds.wires_count, file) == (size_t)ds.wires_count;
+    written = written && fwrite(nt.Js,        sizeof(junction), nt.js_count,    file) == (size_t)nt.js_count;
+
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The network %d cannot be serialized!\n", id);
 
-    fclose(file);
+    return 0;
 }
 
-void serialize_state(
+int serialize_state(
     const datasheet ds,
     const network_topology nt,
     const network_state ns,
@@ -49,16 +51,20 @@ void serialize_state(
 )
 {
     // create and open folder and file of the specific format
-    FILE* file = new_file(STATE_FILE_NAME_FORMAT, path, id, step);
+    FILE* file = create_file(STATE_FILE_NAME_FORMAT, path, id, step);
+    requires(file != NULL, -1, "The state %d of the network %d cannot be serialized!\n", step, id);
 
     // write the junctions weight and the nodes voltage
-    fwrite(ns.Ys, sizeof(double), nt.js_count,    file);
-    fwrite(ns.Vs, sizeof(double), ds.wires_count, file);
+    bool written = fwrite(ns.Ys, sizeof(double), nt.js_count, file) == (size_t)nt.js_count;
+    written = written && fwrite(ns.Vs, sizeof(double), ds.wires_count, file) == (size_t)ds.wires_count;
+
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The state %d of the network %d cannot be serialized!\n", step, id);
 
-    fclose(file);
+    return 0;
 }
 
-void serialize_component(
+int serialize_component(
     const connected_component cc,
     char* path,
     int nn_id,
@@ -66,47 +72,69 @@ void serialize_component(
 )
 {
     // create and open folder and file of the specific format
-    FILE* file = new_file(COMPONENT_FILE_NAME_FORMAT, path, nn_id, cc_id);
+    FILE* file = create_file(COMPONENT_FILE_NAME_FORMAT, path, nn_id, cc_id);
+    requires(file != NULL, -1, "The component %d of the network %d cannot be serialized!\n", cc_id, nn_id);
 
-    fwrite(&cc,   sizeof(int), 4,           file);
-    fwrite(cc.Is, sizeof(int), cc.js_count, file);
+    bool written = fwrite(&cc, sizeof(int), 4, file) == 4;
+    written = written && fwrite(cc.Is, sizeof(int), cc.js_count, file) == (size_t)cc.js_count;
 
-    fclose(file);
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The component %d of the network %d cannot be serialized!\n", cc_id, nn_id);
+
+    return 0;
 }
 
-void serialize_interface(const interface it, char* path, int id, int step)
+int serialize_interface(const interface it, char* path, int id, int step)
 {
     // create and open folder and file of the specific format
-    FILE* file = new_file(INTERFACE_FILE_NAME_FORMAT, path, id, step);
+    FILE* file = create_file(INTERFACE_FILE_NAME_FORMAT, path, id, step);
+    requires(file != NULL, -1, "The interface %d of the network %d cannot be serialized!\n", step, id);
 
     // write the sources, grounds and loads count and mask; write also the
     // loads weights
-    fwrite(&it.sources_count, sizeof(int),    1,                file);
-    fwrite(it.sources_index,  sizeof(int),    it.sources_count, file);
-    fwrite(&it.grounds_count, sizeof(int),    1,                file);
-    fwrite(it.grounds_index,  sizeof(int),    it.grounds_count, file);
-    fwrite(&it.loads_count,   sizeof(int),    1,                file);
-    fwrite(it.loads_index,    sizeof(int),    it.loads_count,   file);
-    fwrite(it.loads_weight,   sizeof(double), it.loads_count,   file);
-
-    fclose(file);
+    bool written = true;
+    written = written && fwrite(&it.sources_count, sizeof(int),    1,                file) == 1;
+    written = written && fwrite(it.sources_index,  sizeof(int),    it.sources_count, file) == (size_t)it.sources_count;
+    written = written && fwrite(&it.grounds_count, sizeof(int),    1,                file) == 1;
+    written = written && fwrite(it.grounds_index,  sizeof(int),    it.grounds_count, file) == (size_t)it.grounds_count;
+    written = written && fwrite(&it.loads_count,   sizeof(int),    1,                file) == 1;
+    written = written && fwrite(it.loads_index,    sizeof(int),    it.loads_count,   file) == (size_t)it.loads_count;
+    written = written && fwrite(it.loads_weight,   sizeof(double), it.loads_count,   file) == (size_t)it.loads_count;
+
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The interface %d of the network %d cannot be serialized!\n", step, id);
+
+    return 0;
 }
 
-void serialize_mea(const MEA mea, char* path, int id, int step)
+int serialize_mea(const MEA mea, char* path, int id, int step)
 {
     // create and open folder and file of the specific format
-    FILE* file = new_file(MEA_FILE_NAME_FORMAT, path, id, step);
+    FILE* file = create_file(MEA_FILE_NAME_FORMAT, path, id, step);
+    requires(file != NULL, -1, "The MEA %d of the network %d cannot be serialized!\n", step, id);
 
     // write the mea arrays to file
-    fwrite(mea.Ps,  sizeof(point),          MEA_ELECTRODES, file);
-    fwrite(mea.e2n, sizeof(int),            MEA_ELECTRODES, file);
-    fwrite(mea.ct,  sizeof(connection_t),   MEA_ELECTRODES, file);
-    fwrite(mea.ws,  sizeof(double),         MEA_ELECTRODES, file);
+    bool written = true;
+    written = written && fwrite(mea.Ps,  sizeof(point),          MEA_ELECTRODES, file) == MEA_ELECTRODES;
+    written = written && fwrite(mea.e2n, sizeof(int),            MEA_ELECTRODES, file) == MEA_ELECTRODES;
+    written = written && fwrite(mea.ct,  sizeof(connection_t),   MEA_ELECTRODES, file) == MEA_ELECTRODES;
+    written = written && fwrite(mea.ws,  sizeof(double),         MEA_ELECTRODES, file) == MEA_ELECTRODES;
+
+    written = fclose(file) == 0 && written;
+    requires(written, -1, "The MEA %d of the network %d cannot be serialized!\n", step, id);
 
-    fclose(file);
+    return 0;
 }
 
 FILE* new_file(char* file_type, char* path, int nn_id, int e_id)
+{
+    FILE* file = create_file(file_type, path, nn_id, e_id);
+    assert(file != NULL, -1, "The file of the device %d cannot be created\n", nn_id);
+
+    return file;
+}
+
+FILE* create_file(char* file_type, char* path, int nn_id, int e_id)
 {
     char name[100];
 
@@ -118,11 +146,16 @@ FILE* new_file(char* file_type, char* path, int nn_id, int e_id)
     snprintf(name, 100, file_type, path, nn_id, e_id);
 
     // open the file and check that it correctly opened
-    FILE* file = fopen(name, "wb");
-    assert(file != NULL, -1, "Impossible to open file: %s for writing operations\n", name);
+    FILE* file = fopen(name, "w+b");
+    requires(file != NULL, NULL, "Impossible to open file: %s for writing operations\n", name);
 
     // write the version of the serialized file
-    fwrite(&VERSION_NUMBER, sizeof(int), 1, file);
+    bool written = fwrite(&VERSION_NUMBER, sizeof(int), 1, file) == 1;
+    if (!written)
+    {
+        fclose(file);
+    }
+    requires(written, NULL, "The version cannot be written to file: %s\n", name);
 
     return file;
 }
@@ -0,0 +1,501 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "io/codec.h"
+#include "io/serializer.h"
+#include "io/trajectory.h"
+#include "stimulator/update.h"
+#include "util/errors.h"
+#include "util/tensors.h"
+
+extern const int VERSION_NUMBER;
+
+// marker closing the footer of a complete container
+static const char FOOTER_MARKER[8] = "NNSTRIX";
+
+// size of the header: version, number of junctions and nanowires, period of
+// the keyframes (0 if the records are not encoded)
+#define HEADER_SIZE (4 * sizeof(int))
+
+// size of the prefix of a record: step, size of the encoding (0 if the record
+// is not encoded)
+#define PREFIX_SIZE (2 * sizeof(int))
+
+// size in the prefix opening the footer, which no record can have: a scan
+// stops at a footer even if it is partially written
+#define FOOTER_OPENING -1
+
+// number of values of a state: Ys and Vs
+#define VALUES_COUNT(TRAJECTORY) ((TRAJECTORY).js_count + (TRAJECTORY).wires_count)
+
+// size of the record of a state, if not encoded
+#define RECORD_SIZE(TRAJECTORY) (PREFIX_SIZE + VALUES_COUNT(TRAJECTORY) * sizeof(double))
+
+// maximum size of an encoded record, without its prefix: the predictor and
+// the encoding
+#define ENCODED_BOUND(TRAJECTORY) (1 + encoded_bound(VALUES_COUNT(TRAJECTORY)))
+
+// predictors of an encoded record, stored in its first byte: the previous
+// record (none for a keyframe), or its conductance update
+#define PREVIOUS_PREDICTOR 0
+#define UPDATE_PREDICTOR 1
+
+// create an empty container, whose records are encoded if the period of the
+// keyframes is positive
+static int create_container(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int keyframe_period,
+    trajectory* tr
+);
+
+// return an empty container on a file, allocating its index and buffers
+static trajectory initial_trajectory(
+    FILE* file,
+    const network_topology nt,
+    int wires_count,
+    int keyframe_period
+);
+
+// free the index and the buffers of a container
+static void release_trajectory(trajectory tr);
+
+// read the index of a container from its footer, or rebuild it by scanning
+// its records if the footer is missing
+static int read_index(trajectory* tr);
+
+// append a record to the index of a container, enlarging it if needed
+static void index_record(trajectory* tr, int step, long long offset);
+
+// read the values of a record, decoding the records from the previous
+// keyframe if encoded
+static int read_values(const trajectory tr, int r, double xs[]);
+
+// predict the values of a record as the ones of the previous record after a
+// step of the conductance update at its voltages
+static void predict_update(const trajectory tr, const double xs[], double predicted[]);
+
+int create_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    trajectory* tr
+)
+{
+    return create_container(ds, nt, path, id, 0, tr);
+}
+
+int create_encoded_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int keyframe_period,
+    trajectory* tr
+)
+{
+    requires(keyframe_period > 0, -1, "The period of the keyframes must be positive!\n");
+
+    return create_container(ds, nt, path, id, keyframe_period, tr);
+}
+
+int open_trajectory(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    trajectory* tr
+)
+{
+    char name[100];
+    snprintf(name, 100, TRAJECTORY_FILE_NAME_FORMAT, path, id);
+
+    FILE* file = fopen(name, "r+b");
+    requires(file != NULL, -1, "Impossible to open file: %s for reading operations\n", name);
+
+    int header[4];
+    bool valid = fread(header, sizeof(int), 4, file) == 4 && header[0] == VERSION_NUMBER;
+    valid = valid && header[1] == nt.js_count && header[2] == ds.wires_count && header[3] >= 0;
+    if (!valid)
+    {
+        fclose(file);
+    }
+    requires(valid, -1, "The file %s is not a trajectory of the network\n", name);
+
+    *tr = initial_trajectory(file, nt, ds.wires_count, header[3]);
+
+    // the values of the last record are the base of the next delta
+    int result = read_index(tr);
+    if (result == 0 && tr->keyframe_period > 0 && tr->records_count > 0)
+    {
+        result = read_values(*tr, tr->records_count - 1, tr->previous);
+    }
+    if (result != 0)
+    {
+        fclose(file);
+        release_trajectory(*tr);
+    }
+    requires(result == 0, -1, "The index of the trajectory %s cannot be read\n", name);
+
+    // remove the footer while the container is open, so that the records
+    // appended and interrupted before the closing are recovered by scanning
+    fflush(file);
+    result = ftruncate(fileno(file), tr->end);
+    if (result != 0)
+    {
+        fclose(file);
+        release_trajectory(*tr);
+    }
+    requires(result == 0, -1, "The trajectory %s cannot be opened for appending\n", name);
+
+    return 0;
+}
+
+int append_state(trajectory* tr, const network_state ns, int step)
+{
+    // the footer is rewritten after the last record at the closing
+    requires(fseek(tr->file, tr->end, SEEK_SET) == 0, -1, "The trajectory cannot be extended!\n");
+
+    int prefix[2] = { step, 0 };
+    long long size = VALUES_COUNT(*tr) * (long long)sizeof(double);
+    bool written;
+    if (tr->keyframe_period == 0)
+    {
+        written = fwrite(prefix, sizeof(int), 2, tr->file) == 2;
+        written = written && fwrite(ns.Ys, sizeof(double), tr->js_count, tr->file) == (size_t)tr->js_count;
+        written = written && fwrite(ns.Vs, sizeof(double), tr->wires_count, tr->file) == (size_t)tr->wires_count;
+    }
+    else
+    {
+        memcpy(tr->current, ns.Ys, tr->js_count * sizeof(double));
+        memcpy(tr->current + tr->js_count, ns.Vs, tr->wires_count * sizeof(double));
+
+        // encode the values as a delta from the previous record, or alone if
+        // the record is a keyframe
+        bool keyframe = tr->records_count % tr->keyframe_period == 0;
+        tr->buffer[0] = PREVIOUS_PREDICTOR;
+        size = 1 + encode_delta(tr->current, keyframe ? NULL : tr->previous, VALUES_COUNT(*tr), tr->buffer + 1);
+
+        // keep the delta from the conductance update, if smaller
+        if (!keyframe)
+        {
+            predict_update(*tr, tr->previous, tr->predicted);
+            tr->candidate[0] = UPDATE_PREDICTOR;
+            long long updated = 1 + encode_delta(tr->current, tr->predicted, VALUES_COUNT(*tr), tr->candidate + 1);
+
+            if (updated < size)
+            {
+                unsigned char* buffer = tr->buffer;
+                tr->buffer = tr->candidate;
+                tr->candidate = buffer;
+                size = updated;
+            }
+        }
+        prefix[1] = size;
+
+        written = fwrite(prefix, sizeof(int), 2, tr->file) == 2;
+        written = written && fwrite(tr->buffer, sizeof(unsigned char), size, tr->file) == (size_t)size;
+    }
+    requires(written, -1, "The state of step %d cannot be written!\n", step);
+
+    index_record(tr, step, tr->end);
+    tr->end += PREFIX_SIZE + size;
+
+    // the values just appended are the base of the next delta
+    double* previous = tr->previous;
+    tr->previous = tr->current;
+    tr->current = previous;
+
+    return 0;
+}
+
+int read_state(const trajectory tr, int step, network_state* ns)
+{
+    // the last record of the step is the most recent state
+    int r = tr.records_count - 1;
+    if (tr.sorted)
+    {
+        // bisect the first record after the step
+        int lo = 0, hi = tr.records_count;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            lo = tr.steps[mid] <= step ? mid + 1 : lo;
+            hi = tr.steps[mid] <= step ? hi : mid;
+        }
+        r = lo > 0 && tr.steps[lo - 1] == step ? lo - 1 : -1;
+    }
+    while (!tr.sorted && r >= 0 && tr.steps[r] != step)
+    {
+        r--;
+    }
+    requires(r >= 0, -1, "The step %d is not in the trajectory!\n", step);
+
+    double* xs = vector(double, VALUES_COUNT(tr) + 1);
+    int result = read_values(tr, r, xs);
+    if (result != 0)
+    {
+        free(xs);
+    }
+    requires(result == 0, -1, "The state of step %d cannot be read!\n", step);
+
+    ns->Ys = vector(double, tr.js_count + 1);
+    ns->Vs = vector(double, tr.wires_count + 1);
+    memcpy(ns->Ys, xs, tr.js_count * sizeof(double));
+    memcpy(ns->Vs, xs + tr.js_count, tr.wires_count * sizeof(double));
+    free(xs);
+
+    return 0;
+}
+
+int close_trajectory(trajectory tr)
+{
+    // the footer follows the last record, and is opened by a prefix with the
+    // number of records
+    long long count = tr.records_count;
+    int opening[2] = { tr.records_count, FOOTER_OPENING };
+    bool written = fseek(tr.file, tr.end, SEEK_SET) == 0;
+    written = written && fwrite(opening, sizeof(int), 2, tr.file) == 2;
+    written = written && fwrite(tr.steps, sizeof(int), tr.records_count, tr.file) == (size_t)tr.records_count;
+    if (tr.keyframe_period > 0)
+    {
+        written = written && fwrite(tr.offsets, sizeof(long long), tr.records_count, tr.file) == (size_t)tr.records_count;
+    }
+    written = written && fwrite(&count, sizeof(long long), 1, tr.file) == 1;
+    written = written && fwrite(FOOTER_MARKER, sizeof(char), sizeof(FOOTER_MARKER), tr.file) == sizeof(FOOTER_MARKER);
+
+    // without the footer, the records are recovered by scanning at the opening
+    written = fclose(tr.file) == 0 && written;
+    release_trajectory(tr);
+    requires(written, -1, "The footer of the trajectory cannot be written!\n");
+
+    return 0;
+}
+
+static int create_container(
+    const datasheet ds,
+    const network_topology nt,
+    char* path,
+    int id,
+    int keyframe_period,
+    trajectory* tr
+)
+{
+    FILE* file = create_file(TRAJECTORY_FILE_NAME_FORMAT, path, id, -1);
+    requires(file != NULL, -1, "The trajectory of the device %d cannot be created!\n", id);
+
+    // the rest of the header follows the version
+    int header[3] = { nt.js_count, ds.wires_count, keyframe_period };
+    bool written = fwrite(header, sizeof(int), 3, file) == 3;
+    if (!written)
+    {
+        fclose(file);
+    }
+    requires(written, -1, "The header of the trajectory of the device %d cannot be written!\n", id);
+
+    *tr = initial_trajectory(file, nt, ds.wires_count, keyframe_period);
+
+    return 0;
+}
+
+static trajectory initial_trajectory(
+    FILE* file,
+    const network_topology nt,
+    int wires_count,
+    int keyframe_period
+)
+{
+    bool encoded = keyframe_period > 0;
+    int count = nt.js_count + wires_count;
+
+    trajectory tr = {
+        .file = file, .js_count = nt.js_count, .wires_count = wires_count,
+        .capacity = 16,
+        .steps = vector(int, 16),
+        .sorted = true,
+        .keyframe_period = keyframe_period,
+        .offsets = vector(long long, 16),
+        .end = HEADER_SIZE
+    };
+
+    if (encoded)
+    {
+        tr.previous = vector(double, count + 1);
+        tr.current = vector(double, count + 1);
+        tr.predicted = vector(double, count + 1);
+        tr.junctions = vector(int, 2 * nt.js_count + 1);
+        tr.buffer = vector(unsigned char, ENCODED_BOUND(tr) + 1);
+        tr.candidate = vector(unsigned char, ENCODED_BOUND(tr) + 1);
+
+        for (int k = 0; k < nt.js_count; k++)
+        {
+            tr.junctions[2 * k] = nt.Js[k].first_wire;
+            tr.junctions[2 * k + 1] = nt.Js[k].second_wire;
+        }
+    }
+
+    return tr;
+}
+
+static void release_trajectory(trajectory tr)
+{
+    free(tr.steps);
+    free(tr.offsets);
+    free(tr.previous);
+    free(tr.current);
+    free(tr.predicted);
+    free(tr.junctions);
+    free(tr.buffer);
+    free(tr.candidate);
+}
+
+static int read_index(trajectory* tr)
+{
+    fseek(tr->file, 0, SEEK_END);
+    long size = ftell(tr->file);
+    bool encoded = tr->keyframe_period > 0;
+
+    // a complete container ends with the marker, preceded by the count
+    char marker[sizeof(FOOTER_MARKER)];
+    long long count = -1;
+    if (size >= (long)(HEADER_SIZE + sizeof(long long) + sizeof(marker)))
+    {
+        fseek(tr->file, size - sizeof(marker) - sizeof(long long), SEEK_SET);
+        fread(&count, sizeof(long long), 1, tr->file);
+        fread(marker, sizeof(char), sizeof(marker), tr->file);
+        count = memcmp(marker, FOOTER_MARKER, sizeof(marker)) == 0 ? count : -1;
+    }
+
+    if (count >= 0)
+    {
+        // the footer contains the opening, the steps, followed by the offsets
+        // if encoded
+        long long entry_size = sizeof(int) + (encoded ? sizeof(long long) : 0);
+        long long end = size - sizeof(marker) - sizeof(long long) - count * entry_size - PREFIX_SIZE;
+        bool valid = end >= (long long)HEADER_SIZE;
+        valid = valid && (encoded || end == (long long)(HEADER_SIZE + count * RECORD_SIZE(*tr)));
+
+        int opening[2];
+        valid = valid && fseek(tr->file, end, SEEK_SET) == 0 && fread(opening, sizeof(int), 2, tr->file) == 2;
+        valid = valid && opening[0] == count && opening[1] == FOOTER_OPENING;
+        requires(valid, -1, "The footer of the trajectory is corrupted!\n");
+
+        int* steps = vector(int, count + 1);
+        long long* offsets = vector(long long, count + 1);
+        bool read = fread(steps, sizeof(int), count, tr->file) == (size_t)count;
+        read = read && (!encoded || fread(offsets, sizeof(long long), count, tr->file) == (size_t)count);
+
+        for (int r = 0; read && r < count; r++)
+        {
+            index_record(tr, steps[r], encoded ? offsets[r] : (long long)(HEADER_SIZE + r * RECORD_SIZE(*tr)));
+        }
+        free(steps);
+        free(offsets);
+        requires(read, -1, "The footer of the trajectory is corrupted!\n");
+
+        tr->end = end;
+
+        return 0;
+    }
+
+    // without footer, only the complete records are indexed: the scan stops
+    // at the opening of a partially written footer, whose size is negative,
+    // while the size of a raw record is 0
+    long long offset = HEADER_SIZE;
+    while (true)
+    {
+        int prefix[2];
+        fseek(tr->file, offset, SEEK_SET);
+        if (fread(prefix, sizeof(int), 2, tr->file) != 2)
+        {
+            break;
+        }
+
+        long long bytes = encoded ? prefix[1] : VALUES_COUNT(*tr) * (long long)sizeof(double);
+        bool complete = encoded ? prefix[1] >= 0 : prefix[1] == 0;
+        complete = complete && bytes <= (long long)ENCODED_BOUND(*tr);
+        if (!complete || offset + (long long)PREFIX_SIZE + bytes > size)
+        {
+            break;
+        }
+
+        index_record(tr, prefix[0], offset);
+        offset += PREFIX_SIZE + bytes;
+    }
+    tr->end = offset;
+
+    return 0;
+}
+
+static void index_record(trajectory* tr, int step, long long offset)
+{
+    if (tr->records_count == tr->capacity)
+    {
+        tr->capacity *= 2;
+        tr->steps = realloc(tr->steps, tr->capacity * sizeof(int));
+        tr->offsets = realloc(tr->offsets, tr->capacity * sizeof(long long));
+        assert(tr->steps != NULL && tr->offsets != NULL, -1, "The index of the trajectory cannot be enlarged!\n");
+    }
+
+    tr->sorted = tr->sorted && (tr->records_count == 0 || tr->steps[tr->records_count - 1] <= step);
+    tr->steps[tr->records_count] = step;
+    tr->offsets[tr->records_count++] = offset;
+}
+
+static int read_values(const trajectory tr, int r, double xs[])
+{
+    int count = VALUES_COUNT(tr);
+
+    if (tr.keyframe_period == 0)
+    {
+        bool read = fseek(tr.file, tr.offsets[r] + PREFIX_SIZE, SEEK_SET) == 0;
+        read = read && fread(xs, sizeof(double), count, tr.file) == (size_t)count;
+        requires(read, -1, "The record %d cannot be read!\n", r);
+
+        return 0;
+    }
+
+    // apply the deltas following the previous keyframe
+    int keyframe = r - r % tr.keyframe_period;
+    for (int q = keyframe; q <= r; q++)
+    {
+        int prefix[2];
+        bool read = fseek(tr.file, tr.offsets[q], SEEK_SET) == 0;
+        read = read && fread(prefix, sizeof(int), 2, tr.file) == 2;
+        read = read && prefix[1] >= 1 && (size_t)prefix[1] <= ENCODED_BOUND(tr);
+        read = read && fread(tr.buffer, sizeof(unsigned char), prefix[1], tr.file) == (size_t)prefix[1];
+
+        // the prediction of the record: none for a keyframe
+        const double* predicted = q == keyframe ? NULL : xs;
+        read = read && (tr.buffer[0] == PREVIOUS_PREDICTOR || (tr.buffer[0] == UPDATE_PREDICTOR && q != keyframe));
+        if (read && tr.buffer[0] == UPDATE_PREDICTOR)
+        {
+            predict_update(tr, xs, tr.predicted);
+            predicted = tr.predicted;
+        }
+
+        read = read && decode_delta(tr.buffer + 1, prefix[1] - 1, predicted, count, xs) == 0;
+        requires(read, -1, "The record %d cannot be decoded!\n", q);
+    }
+
+    return 0;
+}
+
+static void predict_update(const trajectory tr, const double xs[], double predicted[])
+{
+    const double* Vs = xs + tr.js_count;
+
+    for (int k = 0; k < tr.js_count; k++)
+    {
+        double ΔV = fabs(Vs[tr.junctions[2 * k]] - Vs[tr.junctions[2 * k + 1]]);
+        predicted[k] = updated_conductance(xs[k], ΔV);
+    }
+    memcpy(predicted + tr.js_count, Vs, tr.wires_count * sizeof(double));
+}
@@ -0,0 +1,241 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <umfpack.h>
+
+#include "config.h"
+#include "stimulator/ensemble.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// fill the values of the MNA system of a member from its conductances
+static void fill_member(
+    const ensemble_state es,
+    const connected_component cc,
+    int member,
+    const mna_pattern mp,
+    double Ax[]
+);
+
+ensemble_state create_ensemble(
+    const network_state ns,
+    const connected_component cc,
+    int members_count
+)
+{
+    ensemble_state es = {
+        members_count,
+        vector(double, (size_t)cc.js_count * members_count + 1),
+        vector(double, (size_t)cc.ws_count * members_count + 1)
+    };
+
+    // replicate the state of the CC in each member
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        for (int m = 0; m < members_count; m++)
+        {
+            es.Ys[(size_t)k * members_count + m] = ns.Ys[cc.js_skip + k];
+        }
+    }
+
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        for (int m = 0; m < members_count; m++)
+        {
+            es.Vs[(size_t)i * members_count + m] = ns.Vs[cc.ws_skip + i];
+        }
+    }
+
+    return es;
+}
+
+void member_state(
+    const ensemble_state es,
+    const connected_component cc,
+    int member,
+    network_state ns
+)
+{
+    int K = es.members_count;
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        ns.Ys[cc.js_skip + k] = es.Ys[(size_t)k * K + member];
+    }
+
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        ns.Vs[cc.ws_skip + i] = es.Vs[(size_t)i * K + member];
+    }
+}
+
+void ensemble_update(
+    ensemble_state es,
+    const connected_component cc,
+    update_kernel kernel
+)
+{
+    int K = es.members_count;
+
+    // iterate over all the junction indexes
+    #pragma omp parallel for if((long)cc.js_count * K >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        // get the index of the wires in the CC, once for all the members
+        const double* Vi = es.Vs + (size_t)(cc.Is[k] / cc.ws_count) * K;
+        const double* Vj = es.Vs + (size_t)(cc.Is[k] % cc.ws_count) * K;
+        double* Ys = es.Ys + (size_t)k * K;
+
+        // compute the potentiation and depression coefficients of each member
+        double xs[K], kps[K], kds[K];
+        for (int m = 0; m < K; m++)
+        {
+            xs[m] = ETA_P * fabs(Vi[m] - Vj[m]);
+        }
+        vectorized_exp(kernel, xs, kps, K);
+
+        for (int m = 0; m < K; m++)
+        {
+            xs[m] = -ETA_D * fabs(Vi[m] - Vj[m]);
+        }
+        vectorized_exp(kernel, xs, kds, K);
+
+        for (int m = 0; m < K; m++)
+        {
+            kps[m] *= KP;
+            kds[m] *= KD;
+            xs[m] = -TAU * (kps[m] + kds[m]);
+        }
+        vectorized_exp(kernel, xs, xs, K);
+
+        // calculate the conductance of the junction of each member
+        for (int m = 0; m < K; m++)
+        {
+            double kpd = kps[m] + kds[m];
+            double g = (Ys[m] - Y_MIN) / (Y_MAX - Y_MIN);
+            g = kps[m] / kpd * (1 + kds[m] / kps[m] * g * xs[m]);
+
+            Ys[m] = Y_MIN + g * (Y_MAX - Y_MIN);
+        }
+    }
+}
+
+int ensemble_stimulation(
+    ensemble_state es,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    const mna_pattern mp
+)
+{
+    int K = es.members_count;
+    int failures = 0;
+
+    // the members share the symbolic analysis, while each one has its own
+    // values and numeric factorization
+    #pragma omp parallel for reduction(+:failures)
+    for (int m = 0; m < K; m++)
+    {
+        double* Ax = vector(double, mp.Ap[mp.size] + 1);
+        double b[mp.size], x[mp.size];
+        fill_member(es, cc, m, mp, Ax);
+
+        // set the voltage of the sources in the right-hand side
+        memset(b, 0, mp.size * sizeof(double));
+        for (int i = 0; i < it.sources_count; i++)
+        {
+            if (mp.s2x[i] >= 0)
+            {
+                b[mp.s2x[i]] = ios[(size_t)i * K + m];
+            }
+        }
+
+        double info[UMFPACK_INFO];
+        void* Numeric;
+        umfpack_di_numeric(mp.Ap, mp.Ai, Ax, mp.Symbolic, &Numeric, NULL, info);
+        if (info[UMFPACK_STATUS] == UMFPACK_OK)
+        {
+            umfpack_di_solve(UMFPACK_A, mp.Ap, mp.Ai, Ax, x, b, Numeric, NULL, info);
+        }
+        umfpack_di_free_numeric(&Numeric);
+        free(Ax);
+
+        if (info[UMFPACK_STATUS] != UMFPACK_OK)
+        {
+            failures++;
+            continue;
+        }
+
+        // set the voltages of the member (the grounds are at 0 volts)
+        for (int i = 0; i < cc.ws_count; i++)
+        {
+            es.Vs[(size_t)i * K + m] = mp.n2x[i] >= 0 ? x[mp.n2x[i]] : 0;
+        }
+
+        // set the value of the source nodes in the voltage array,
+        // and the intensity of the drawn current in the io array
+        for (int i = 0; i < it.sources_count; i++)
+        {
+            if (mp.s2x[i] >= 0)
+            {
+                es.Vs[(size_t)(it.sources_index[i] - cc.ws_skip) * K + m] = ios[(size_t)i * K + m];
+                ios[(size_t)i * K + m] = - x[mp.s2x[i]];
+            }
+        }
+    }
+    requires(failures == 0, -1, "The MNA system of %d members cannot be solved!\n", failures);
+
+    return 0;
+}
+
+void destroy_ensemble(ensemble_state es)
+{
+    free(es.Ys);
+    free(es.Vs);
+}
+
+static void fill_member(
+    const ensemble_state es,
+    const connected_component cc,
+    int member,
+    const mna_pattern mp,
+    double Ax[]
+)
+{
+    int K = es.members_count;
+
+    // the source markers are shared with the cached system
+    memcpy(Ax, mp.Ax, mp.Ap[mp.size] * sizeof(double));
+
+    // the diagonal of a nanowire starts from the weight of its load
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (mp.Dx[i] >= 0)
+        {
+            Ax[mp.Dx[i]] = mp.ws[i];
+        }
+    }
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double Y = es.Ys[(size_t)k * K + member];
+        const int* Jx = mp.Jx + 4 * k;
+
+        for (int e = 0; e < 2; e++)
+        {
+            if (Jx[e] >= 0)
+            {
+                Ax[Jx[e]] += Y;
+            }
+        }
+
+        for (int e = 2; e < 4; e++)
+        {
+            if (Jx[e] >= 0)
+            {
+                Ax[Jx[e]] = - Y;
+            }
+        }
+    }
+}
@@ -0,0 +1,343 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "stimulator/kernels.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// the SIMD kernels are compiled for x86-64 through the target attribute, so
+// that the library does not require them to run
+#if defined(__x86_64__) && defined(__GNUC__)
+#define X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// arguments of the exponential outside which the result saturates
+#define EXP_MIN -708.0
+#define EXP_MAX 709.0
+
+// coefficients of the Taylor polynomial of the exponential, from degree 13
+static const double TAYLOR[14] = {
+    1.0 / 6227020800, 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800,
+    1.0 / 362880, 1.0 / 40320, 1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24,
+    1.0 / 6, 1.0 / 2, 1.0, 1.0
+};
+
+// update the conductance of the junctions in [from, to) with the C math
+// library
+static void scalar_update(network_state ns, const update_plan up, int from, int to);
+
+#ifdef X86_KERNELS
+
+// evaluate the exponential of 4 arguments
+static __m256d exp_avx2(__m256d x);
+
+// evaluate the exponential of 8 arguments
+static __m512d exp_avx512(__m512d x);
+
+// evaluate the exponential of the leading multiple of 4 arguments of an array,
+// returning their number
+static int avx2_exp(const double xs[], double ys[], int n);
+
+// evaluate the exponential of the leading multiple of 8 arguments of an array,
+// returning their number
+static int avx512_exp(const double xs[], double ys[], int n);
+
+// update the conductance of the junctions of a plan 4 at a time
+static void avx2_update(network_state ns, const update_plan up);
+
+// update the conductance of the junctions of a plan 8 at a time
+static void avx512_update(network_state ns, const update_plan up);
+
+#endif
+
+bool supported_update_kernel(update_kernel kernel)
+{
+    switch (kernel)
+    {
+        case SCALAR_KERNEL:
+            return true;
+#ifdef X86_KERNELS
+        case AVX2_KERNEL:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case AVX512_KERNEL:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+update_kernel best_update_kernel()
+{
+    if (supported_update_kernel(AVX512_KERNEL))
+    {
+        return AVX512_KERNEL;
+    }
+    if (supported_update_kernel(AVX2_KERNEL))
+    {
+        return AVX2_KERNEL;
+    }
+    return SCALAR_KERNEL;
+}
+
+int create_update_plan(
+    const connected_component cc,
+    update_kernel kernel,
+    update_plan* up
+)
+{
+    requires(supported_update_kernel(kernel), -1, "The update kernel is not supported by the processor!\n");
+
+    *up = (update_plan) {
+        kernel,
+        cc.js_count,
+        cc.js_skip,
+        vector(int, cc.js_count + 1),
+        vector(int, cc.js_count + 1)
+    };
+
+    // decode the endpoints of each junction once
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        up->Ei[k] = cc.ws_skip + cc.Is[k] / cc.ws_count;
+        up->Ej[k] = cc.ws_skip + cc.Is[k] % cc.ws_count;
+    }
+
+    return 0;
+}
+
+void vectorized_update(network_state ns, const update_plan up)
+{
+    switch (up.kernel)
+    {
+#ifdef X86_KERNELS
+        case AVX2_KERNEL:
+            avx2_update(ns, up);
+            break;
+        case AVX512_KERNEL:
+            avx512_update(ns, up);
+            break;
+#endif
+        default:
+            #pragma omp parallel for if(up.js_count >= parallel_threshold(UPDATE_GRAIN))
+            for (int k = 0; k < up.js_count; k++)
+            {
+                scalar_update(ns, up, k, k + 1);
+            }
+    }
+}
+
+void vectorized_exp(update_kernel kernel, const double xs[], double ys[], int n)
+{
+    int k = 0;
+
+#ifdef X86_KERNELS
+    if (kernel == AVX2_KERNEL)
+    {
+        k = avx2_exp(xs, ys, n);
+    }
+    if (kernel == AVX512_KERNEL)
+    {
+        k = avx512_exp(xs, ys, n);
+    }
+#else
+    (void)kernel;
+#endif
+
+    for (; k < n; k++)
+    {
+        ys[k] = exp(xs[k]);
+    }
+}
+
+void destroy_update_plan(update_plan up)
+{
+    free(up.Ei);
+    free(up.Ej);
+}
+
+static void scalar_update(network_state ns, const update_plan up, int from, int to)
+{
+    for (int k = from; k < to; k++)
+    {
+        // calculate the delta voltage on each junction
+        double ΔV = fabs(ns.Vs[up.Ei[k]] - ns.Vs[up.Ej[k]]);
+
+        // compute the potentiation and depression coefficients
+        double kp = KP * exp(ETA_P * ΔV);
+        double kd = KD * exp(-ETA_D * ΔV);
+        double kpd = kp + kd;
+
+        // calculate the conductance of the junction
+        double g = (ns.Ys[up.js_skip + k] - Y_MIN) / (Y_MAX - Y_MIN);
+        g = kp / kpd * (1 + kd / kp * g * exp(-TAU * kpd));
+
+        // calculate and set circuit admittance
+        ns.Ys[up.js_skip + k] = Y_MIN + g * (Y_MAX - Y_MIN);
+    }
+}
+
+#ifdef X86_KERNELS
+
+__attribute__((target("avx2,fma")))
+static __m256d exp_avx2(__m256d x)
+{
+    // round x / ln(2) to the nearest integer n, keeping its bits in the
+    // mantissa of the shifted value
+    const __m256d shifter = _mm256_set1_pd(0x1.8p52);
+    __m256d c = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(EXP_MAX)), _mm256_set1_pd(EXP_MIN));
+    __m256d s = _mm256_fmadd_pd(c, _mm256_set1_pd(M_LOG2E), shifter);
+    __m256d n = _mm256_sub_pd(s, shifter);
+
+    // reduce the argument to r = x - n * ln(2), in two parts for accuracy
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(0x1.62e42fefa39efp-1), c);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(0x1.abc9e3b39803fp-56), r);
+
+    // evaluate the Taylor polynomial of e^r with the Horner scheme
+    __m256d p = _mm256_set1_pd(TAYLOR[0]);
+    for (int i = 1; i < 14; i++)
+    {
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(TAYLOR[i]));
+    }
+
+    // scale by 2^n building its exponent bits
+    __m256i e = _mm256_sub_epi64(_mm256_castpd_si256(s), _mm256_castpd_si256(shifter));
+    e = _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+    __m256d y = _mm256_mul_pd(p, _mm256_castsi256_pd(e));
+
+    // saturate the results outside the range
+    y = _mm256_blendv_pd(y, _mm256_setzero_pd(), _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MIN), _CMP_LT_OQ));
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(INFINITY), _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MAX), _CMP_GT_OQ));
+    return y;
+}
+
+__attribute__((target("avx512f")))
+static __m512d exp_avx512(__m512d x)
+{
+    // round x / ln(2) to the nearest integer n, keeping its bits in the
+    // mantissa of the shifted value
+    const __m512d shifter = _mm512_set1_pd(0x1.8p52);
+    __m512d c = _mm512_max_pd(_mm512_min_pd(x, _mm512_set1_pd(EXP_MAX)), _mm512_set1_pd(EXP_MIN));
+    __m512d s = _mm512_fmadd_pd(c, _mm512_set1_pd(M_LOG2E), shifter);
+    __m512d n = _mm512_sub_pd(s, shifter);
+
+    // reduce the argument to r = x - n * ln(2), in two parts for accuracy
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(0x1.62e42fefa39efp-1), c);
+    r = _mm512_fnmadd_pd(n, _mm512_set1_pd(0x1.abc9e3b39803fp-56), r);
+
+    // evaluate the Taylor polynomial of e^r with the Horner scheme
+    __m512d p = _mm512_set1_pd(TAYLOR[0]);
+    for (int i = 1; i < 14; i++)
+    {
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(TAYLOR[i]));
+    }
+
+    // scale by 2^n building its exponent bits
+    __m512i e = _mm512_sub_epi64(_mm512_castpd_si512(s), _mm512_castpd_si512(shifter));
+    e = _mm512_slli_epi64(_mm512_add_epi64(e, _mm512_set1_epi64(1023)), 52);
+    __m512d y = _mm512_mul_pd(p, _mm512_castsi512_pd(e));
+
+    // saturate the results outside the range
+    y = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, _mm512_set1_pd(EXP_MIN), _CMP_LT_OQ), y, _mm512_setzero_pd());
+    y = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, _mm512_set1_pd(EXP_MAX), _CMP_GT_OQ), y, _mm512_set1_pd(INFINITY));
+    return y;
+}
+
+__attribute__((target("avx2,fma")))
+static int avx2_exp(const double xs[], double ys[], int n)
+{
+    int k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        _mm256_storeu_pd(ys + k, exp_avx2(_mm256_loadu_pd(xs + k)));
+    }
+    return k;
+}
+
+__attribute__((target("avx512f")))
+static int avx512_exp(const double xs[], double ys[], int n)
+{
+    int k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        _mm512_storeu_pd(ys + k, exp_avx512(_mm512_loadu_pd(xs + k)));
+    }
+    return k;
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_update(network_state ns, const update_plan up)
+{
+    int blocks = up.js_count / 4;
+
+    // iterate over the blocks of 4 junctions
+    #pragma omp parallel for if(up.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int b = 0; b < blocks; b++)
+    {
+        int k = 4 * b;
+
+        // gather the voltage of the endpoints and calculate the delta voltage
+        __m128i i = _mm_loadu_si128((const __m128i*)(up.Ei + k));
+        __m128i j = _mm_loadu_si128((const __m128i*)(up.Ej + k));
+        __m256d ΔV = _mm256_sub_pd(_mm256_i32gather_pd(ns.Vs, i, 8), _mm256_i32gather_pd(ns.Vs, j, 8));
+        ΔV = _mm256_andnot_pd(_mm256_set1_pd(-0.0), ΔV);
+
+        // compute the potentiation and depression coefficients
+        __m256d kp = _mm256_mul_pd(_mm256_set1_pd(KP), exp_avx2(_mm256_mul_pd(_mm256_set1_pd(ETA_P), ΔV)));
+        __m256d kd = _mm256_mul_pd(_mm256_set1_pd(KD), exp_avx2(_mm256_mul_pd(_mm256_set1_pd(-ETA_D), ΔV)));
+        __m256d kpd = _mm256_add_pd(kp, kd);
+        __m256d decay = exp_avx2(_mm256_mul_pd(_mm256_set1_pd(-TAU), kpd));
+
+        // calculate the conductance of the junctions: (kp + kd * e * g) / kpd
+        __m256d Y = _mm256_loadu_pd(ns.Ys + up.js_skip + k);
+        __m256d g = _mm256_div_pd(_mm256_sub_pd(Y, _mm256_set1_pd(Y_MIN)), _mm256_set1_pd(Y_MAX - Y_MIN));
+        g = _mm256_div_pd(_mm256_fmadd_pd(_mm256_mul_pd(kd, decay), g, kp), kpd);
+
+        // calculate and set circuit admittance
+        Y = _mm256_fmadd_pd(g, _mm256_set1_pd(Y_MAX - Y_MIN), _mm256_set1_pd(Y_MIN));
+        _mm256_storeu_pd(ns.Ys + up.js_skip + k, Y);
+    }
+
+    scalar_update(ns, up, 4 * blocks, up.js_count);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_update(network_state ns, const update_plan up)
+{
+    int blocks = up.js_count / 8;
+
+    // iterate over the blocks of 8 junctions
+    #pragma omp parallel for if(up.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int b = 0; b < blocks; b++)
+    {
+        int k = 8 * b;
+
+        // gather the voltage of the endpoints and calculate the delta voltage
+        __m256i i = _mm256_loadu_si256((const __m256i*)(up.Ei + k));
+        __m256i j = _mm256_loadu_si256((const __m256i*)(up.Ej + k));
+        __m512d ΔV = _mm512_sub_pd(_mm512_i32gather_pd(i, ns.Vs, 8), _mm512_i32gather_pd(j, ns.Vs, 8));
+        ΔV = _mm512_abs_pd(ΔV);
+
+        // compute the potentiation and depression coefficients
+        __m512d kp = _mm512_mul_pd(_mm512_set1_pd(KP), exp_avx512(_mm512_mul_pd(_mm512_set1_pd(ETA_P), ΔV)));
+        __m512d kd = _mm512_mul_pd(_mm512_set1_pd(KD), exp_avx512(_mm512_mul_pd(_mm512_set1_pd(-ETA_D), ΔV)));
+        __m512d kpd = _mm512_add_pd(kp, kd);
+        __m512d decay = exp_avx512(_mm512_mul_pd(_mm512_set1_pd(-TAU), kpd));
+
+        // calculate the conductance of the junctions: (kp + kd * e * g) / kpd
+        __m512d Y = _mm512_loadu_pd(ns.Ys + up.js_skip + k);
+        __m512d g = _mm512_div_pd(_mm512_sub_pd(Y, _mm512_set1_pd(Y_MIN)), _mm512_set1_pd(Y_MAX - Y_MIN));
+        g = _mm512_div_pd(_mm512_fmadd_pd(_mm512_mul_pd(kd, decay), g, kp), kpd);
+
+        // calculate and set circuit admittance
+        Y = _mm512_fmadd_pd(g, _mm512_set1_pd(Y_MAX - Y_MIN), _mm512_set1_pd(Y_MIN));
+        _mm512_storeu_pd(ns.Ys + up.js_skip + k, Y);
+    }
+
+    scalar_update(ns, up, 8 * blocks, up.js_count);
+}
+
+#endif
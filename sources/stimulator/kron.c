@@ -0,0 +1,176 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stimulator/kron.h"
+#include "stimulator/pattern.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+int kron_reduce(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    bool full,
+    const mna_settings settings,
+    kron_reduction* kr
+)
+{
+    // list the sources of the interface connected to the CC
+    int* sources = vector(int, it.sources_count + 1);
+    int sources_count = 0;
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            sources[sources_count++] = i;
+        }
+    }
+
+    // list the nanowires to reconstruct: all of them, or only the electrodes
+    // (each one once, in the order of the CC)
+    bool electrode[cc.ws_count] = { };
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            electrode[nwi] = true;
+        }
+    }
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            electrode[nwi] = true;
+        }
+    }
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            electrode[nwi] = true;
+        }
+    }
+
+    int* ws_index = vector(int, cc.ws_count);
+    int ws_count = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (full || electrode[i])
+        {
+            ws_index[ws_count++] = cc.ws_skip + i;
+        }
+    }
+
+    double* Ks = zeros_vector(double, sources_count * sources_count + 1);
+    double* Ms = zeros_vector(double, (size_t)ws_count * sources_count + 1);
+
+    // the system is the same for all the sources: without a reduction, it is
+    // assembled and factorized once, and solved for each source
+    mna_pattern mp;
+    void* Numeric = NULL;
+    bool factorized = sources_count > 0 && settings.solver == DIRECT_SOLVER && settings.reduction == NULL;
+    int result = factorized ? create_pattern(ns, cc, it, settings, &mp) : 0;
+    if (factorized && result == 0)
+    {
+        result = factorize_pattern(mp, &Numeric);
+        if (result != 0)
+        {
+            destroy_pattern(mp);
+            Numeric = NULL;
+        }
+    }
+
+    // the response to a unitary voltage on a source (with the other sources
+    // grounded) is a column of the reduced matrices
+    double io[it.sources_count + 1];
+    for (int c = 0; c < sources_count && result == 0; c++)
+    {
+        memset(io, 0, it.sources_count * sizeof(double));
+        io[sources[c]] = 1;
+
+        result = factorized
+            ? factorized_stimulation(ns, cc, it, io, mp, Numeric)
+            : voltage_stimulation_with(ns, cc, it, io, settings);
+
+        for (int r = 0; r < sources_count; r++)
+        {
+            Ks[r * sources_count + c] = io[sources[r]];
+        }
+
+        for (int w = 0; w < ws_count; w++)
+        {
+            Ms[(size_t)w * sources_count + c] = ns.Vs[ws_index[w]];
+        }
+    }
+
+    if (factorized && Numeric != NULL)
+    {
+        destroy_factorization(Numeric);
+        destroy_pattern(mp);
+    }
+
+    if (result != 0)
+    {
+        free(sources);
+        free(ws_index);
+        free(Ks);
+        free(Ms);
+    }
+    requires(result == 0, -1, "The Kron reduction of the CC cannot be computed!\n");
+
+    *kr = (kron_reduction) {
+        sources_count,
+        sources,
+        Ks,
+        ws_count,
+        ws_index,
+        Ms
+    };
+
+    return 0;
+}
+
+void kron_stimulation(network_state ns, const kron_reduction kr, double io[])
+{
+    // save the input voltages before overwriting them with the currents
+    double vs[kr.sources_count + 1];
+    for (int c = 0; c < kr.sources_count; c++)
+    {
+        vs[c] = io[kr.sources[c]];
+    }
+
+    #pragma omp parallel for if((long)kr.ws_count * kr.sources_count >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int w = 0; w < kr.ws_count; w++)
+    {
+        double V = 0;
+        for (int c = 0; c < kr.sources_count; c++)
+        {
+            V += kr.Ms[(size_t)w * kr.sources_count + c] * vs[c];
+        }
+        ns.Vs[kr.ws_index[w]] = V;
+    }
+
+    for (int r = 0; r < kr.sources_count; r++)
+    {
+        double I = 0;
+        for (int c = 0; c < kr.sources_count; c++)
+        {
+            I += kr.Ks[r * kr.sources_count + c] * vs[c];
+        }
+        io[kr.sources[r]] = I;
+    }
+}
+
+void destroy_kron_reduction(kron_reduction kr)
+{
+    free(kr.sources);
+    free(kr.ws_index);
+    free(kr.Ks);
+    free(kr.Ms);
+}
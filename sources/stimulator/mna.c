@@ -1,10 +1,24 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <umfpack.h>
 
 #include "device/datasheet.h"
 #include "stimulator/mna.h"
+#include "stimulator/schur.h"
 #include "util/errors.h"
+#include "util/parallelism.h"
+
+// solve the MNA system of the reduced CC given in the settings, and expand its
+// solution to the nanowires of the original CC
+static int reduced_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    mna_settings settings
+);
 
 // Useful links:
 // UMFPACK: https://users.encs.concordia.ca/~krzyzak/R%20Code-Communications%20in%20Statistics%20and%20Simulation%202014/Zubeh%F6r/SuiteSparse/UMFPACK/Doc/QuickStart.pdf
@@ -17,6 +31,33 @@ int voltage_stimulation(
     double io[]
 )
 {
+    return voltage_stimulation_with(ns, cc, it, io, (mna_settings){ });
+}
+
+int voltage_stimulation_with(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_settings settings
+)
+{
+    if (settings.reduction != NULL)
+    {
+        return reduced_stimulation(ns, cc, it, io, settings);
+    }
+
+    // the subdomain of each nanowire must be in the partition, or -1 if the
+    // nanowire is in the interface
+    if (settings.solver == SCHUR_SOLVER)
+    {
+        requires(settings.Ds != NULL && settings.domains_count >= 1, -1, "The subdomains of the Schur solver are missing!\n");
+        for (int i = 0; i < cc.ws_count; i++)
+        {
+            requires(-1 <= settings.Ds[i] && settings.Ds[i] < settings.domains_count, -1, "The nanowire %d is in the subdomain %d, out of the %d subdomains!\n", i, settings.Ds[i], settings.domains_count);
+        }
+    }
+
     // describe the nanowire connection type (default none), and create an
     // array containing the weight of a possible load connected to a nanowire
     connection_t nct[cc.ws_count] = { };
@@ -232,30 +273,80 @@ int voltage_stimulation(
         }
     }
 
-    // create an array to retrieve the information about the sys. eq. solution
-    double info[UMFPACK_INFO];
+    if (settings.solver == SCHUR_SOLVER)
+    {
+        // assign each unknown of the system to the subdomain of its nanowire;
+        // the current of a source follows the subdomain of its nanowire
+        int dom[size];
+        for (int i = 0; i < cc.ws_count; i++)
+        {
+            if (nct[i] != GROUND)
+            {
+                dom[n2n[i]] = settings.Ds[i];
+            }
 
-    // perform a column pre-ordering to reduce fill-in and a symbolic factorization
-    void* Symbolic;
-    umfpack_di_symbolic(size, size, Ap, Ai, Ax, &Symbolic, NULL, info);
-    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "Columns contain row indices in increasing order / with duplicates! The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+            if (nct[i] == SOURCE)
+            {
+                dom[s2n[i]] = settings.Ds[i];
+            }
+        }
 
-    // perform the numerical factorization, PAQ=LU, PRAQ=LU, or P(R\A)Q=LU
-    void* Numeric;
-    umfpack_di_numeric(Ap, Ai, Ax, Symbolic, &Numeric, NULL, info);
-    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "Numeric factorization was unsuccessful! The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+        // solve the system by domain decomposition
+        int result = schur_solve(size, Ap, Ai, Ax, x, b, dom, settings.domains_count);
+        requires(result == 0, -1, "The MNA system cannot be solved by domain decomposition!\n");
+    }
+    else
+    {
+        // create an array to retrieve the information about the sys. eq. solution
+        double info[UMFPACK_INFO];
+
+        // perform a column pre-ordering to reduce fill-in and a symbolic
+        // factorization; if an ordering of the nanowires is given, translate it
+        // to the MNA columns (skipping grounds and placing each source column
+        // next to its nanowire) and use it instead of the UMFPACK one
+        void* Symbolic;
+        if (settings.Qs != NULL)
+        {
+            int Q[size];
+            for (int k = 0, q = 0; k < cc.ws_count; k++)
+            {
+                int i = settings.Qs[k];
 
-    // solve a linear system for the solution X
-    umfpack_di_solve(UMFPACK_A, Ap, Ai, Ax, x, b, Numeric, NULL, info);
-    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+                if (nct[i] != GROUND)
+                {
+                    Q[q++] = n2n[i];
+                }
 
-    // deallocate the Symbolic and Numeric objects
-    umfpack_di_free_symbolic(&Symbolic);
-    umfpack_di_free_numeric(&Numeric);
+                if (nct[i] == SOURCE)
+                {
+                    Q[q++] = s2n[i];
+                }
+            }
+            umfpack_di_qsymbolic(size, size, Ap, Ai, Ax, Q, &Symbolic, NULL, info);
+        }
+        else
+        {
+            umfpack_di_symbolic(size, size, Ap, Ai, Ax, &Symbolic, NULL, info);
+        }
+        requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "Columns contain row indices in increasing order / with duplicates! The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+
+        // perform the numerical factorization, PAQ=LU, PRAQ=LU, or P(R\A)Q=LU
+        void* Numeric;
+        umfpack_di_numeric(Ap, Ai, Ax, Symbolic, &Numeric, NULL, info);
+        requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "Numeric factorization was unsuccessful! The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+
+        // solve a linear system for the solution X
+        umfpack_di_solve(UMFPACK_A, Ap, Ai, Ax, x, b, Numeric, NULL, info);
+        requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+
+        // deallocate the Symbolic and Numeric objects
+        umfpack_di_free_symbolic(&Symbolic);
+        umfpack_di_free_numeric(&Numeric);
+    }
 
     // set the voltages in the ns.Vs array and the input currents
     // in the io array according to the MNA calculation
-    #pragma omp parallel for
+    #pragma omp parallel for if(cc.ws_count >= parallel_threshold(CIRCUIT_GRAIN))
     for (int i = 0; i < cc.ws_count; i++)
     {
         int nsi = cc.ws_skip + i;
@@ -292,6 +383,67 @@ int voltage_stimulation(
     return 0;
 }
 
+double voltage_error_estimate(
+    const network_state ns,
+    const connected_component cc,
+    const interface it
+)
+{
+    // the residual and the total conductance of each nanowire
+    double rs[cc.ws_count] = { }, ds[cc.ws_count] = { };
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        int i = cc.Is[k] / cc.ws_count;
+        int j = cc.Is[k] % cc.ws_count;
+        double y = ns.Ys[cc.js_skip + k];
+        double I = y * (ns.Vs[cc.ws_skip + i] - ns.Vs[cc.ws_skip + j]);
+
+        rs[i] += I;
+        rs[j] -= I;
+        ds[i] += y;
+        ds[j] += y;
+    }
+
+    // a load drains current towards the ground
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            rs[nwi] += it.loads_weight[i] * ns.Vs[it.loads_index[i]];
+            ds[nwi] += it.loads_weight[i];
+        }
+    }
+
+    // the sources and the grounds have a fixed voltage, and any current
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            rs[nwi] = 0;
+        }
+    }
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            rs[nwi] = 0;
+        }
+    }
+
+    double residual = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        double r = ds[i] > 0 ? fabs(rs[i]) / ds[i] : 0;
+        residual = r > residual ? r : residual;
+    }
+
+    return residual;
+}
+
 int voltage_stimulation_mea(
     network_state ns,
     const connected_component cc,
@@ -304,3 +456,97 @@ int voltage_stimulation_mea(
     destroy_interface(it);
     return result;
 }
+
+static int reduced_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    mna_settings settings
+)
+{
+    const reduced_component rc = *settings.reduction;
+    settings.reduction = NULL;
+
+    // create the state of the reduced CC
+    double Ys[rc.cc.js_count + 1], Vs[rc.cc.ws_count];
+    network_state rs = { Ys, Vs };
+    reduce_state(ns, cc, rc, rs);
+
+    // map the electrodes connected to the CC on the reduced CC; the
+    // electrodes are never removed by the reduction, so they are mapped on
+    // themselves; rio contains the entries of io for the mapped sources
+    int sources[it.sources_count + 1], r2s[it.sources_count + 1];
+    int grounds[it.grounds_count + 1], loads[it.loads_count + 1];
+    double weights[it.loads_count + 1], rio[it.sources_count + 1];
+    interface rit = { 0, sources, 0, grounds, 0, loads, weights };
+
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            r2s[rit.sources_count] = i;
+            rio[rit.sources_count] = io[i];
+            sources[rit.sources_count++] = rc.w2r[nwi];
+        }
+    }
+
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            grounds[rit.grounds_count++] = rc.w2r[nwi];
+        }
+    }
+
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            weights[rit.loads_count] = it.loads_weight[i];
+            loads[rit.loads_count++] = rc.w2r[nwi];
+        }
+    }
+
+    // a reduced CC made of a single nanowire has no system to solve: its
+    // voltage is the one of its source, if any, and the current drawn is the
+    // one drained by the loads on the nanowire
+    if (rc.cc.js_count == 0)
+    {
+        double load_weight = 0;
+        for (int i = 0; i < rit.loads_count; i++)
+        {
+            load_weight += weights[i];
+        }
+
+        Vs[0] = rit.sources_count > 0 ? rio[0] : 0;
+        for (int i = 0; i < rit.sources_count; i++)
+        {
+            rio[i] = load_weight * Vs[0];
+        }
+    }
+    else
+    {
+        int result = voltage_stimulation_with(rs, rc.cc, rit, rio, settings);
+        requires(result == 0, -1, "The reduced MNA system cannot be solved!\n");
+    }
+
+    expand_state(ns, cc, rc, rs);
+
+    // set the value of the source nodes in the voltage array (as done by the
+    // unreduced stimulation), and the current drawn by the CC sources
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        ns.Vs[it.sources_index[i]] = io[i];
+    }
+
+    for (int i = 0; i < rit.sources_count; i++)
+    {
+        io[r2s[i]] = rio[i];
+    }
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stimulator/ordering.h"
+#include "util/components.h"
+#include "util/tensors.h"
+
+// number of nanowires under which a group is not dissected anymore
+#define LEAF_SIZE 16
+
+// nanowire of a connected component together with its centroid position
+typedef struct
+{
+    point   p;  // centroid of the nanowire
+    int     w;  // index of the nanowire in the connected component
+} located_wire;
+
+// compare two located wires according to their x and y coordinates
+static int xcmp(const void* e1, const void* e2);
+static int ycmp(const void* e1, const void* e2);
+
+// check if a nanowire has a neighbour in the other half of the group
+static bool on_boundary(int w, const int Ap[], const int Aj[], const char side[]);
+
+// collect the nanowires of a CC together with their centroid
+static located_wire* locate(
+    const network_topology nt,
+    const connected_component cc
+);
+
+// split the `n` nanowires in `lws` at the `half`-th centroid and reorder them
+// as [first half, second half, separator]
+static void bisect(
+    located_wire lws[],
+    int n,
+    int half,
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[],
+    int* first_count,
+    int* second_count
+);
+
+// recursively order the `n` nanowires in `lws` as [half, half, separator]
+static void dissect(
+    located_wire lws[],
+    int n,
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[]
+);
+
+// recursively assign the `n` nanowires in `lws` to `domains_count` domains
+// starting from `first_domain`, or to the interface
+static void partition(
+    located_wire lws[],
+    int n,
+    int domains_count,
+    int first_domain,
+    int Ds[],
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[]
+);
+
+void geometric_ordering(
+    const network_topology nt,
+    const connected_component cc,
+    int Qs[]
+)
+{
+    int* Ap = vector(int, cc.ws_count + 1);
+    int* Aj = vector(int, 2 * cc.js_count + 1);
+    construe_adjacency_lists(cc, Ap, Aj, NULL);
+
+    located_wire* lws = locate(nt, cc);
+    located_wire* tmp = vector(located_wire, cc.ws_count);
+
+    // recursively split the nanowires; the side array is used to mark the
+    // half containing a nanowire (0 if not in the dissected group)
+    char* side = zeros_vector(char, cc.ws_count);
+    dissect(lws, cc.ws_count, Ap, Aj, side, tmp);
+
+    // the position of a nanowire in the array is its elimination order
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        Qs[i] = lws[i].w;
+    }
+
+    free(Ap);
+    free(Aj);
+    free(lws);
+    free(tmp);
+    free(side);
+}
+
+void spatial_partition(
+    const network_topology nt,
+    const connected_component cc,
+    int domains_count,
+    int Ds[]
+)
+{
+    int* Ap = vector(int, cc.ws_count + 1);
+    int* Aj = vector(int, 2 * cc.js_count + 1);
+    construe_adjacency_lists(cc, Ap, Aj, NULL);
+
+    located_wire* lws = locate(nt, cc);
+    located_wire* tmp = vector(located_wire, cc.ws_count);
+
+    // recursively split the nanowires; the side array is used to mark the
+    // half containing a nanowire (0 if not in the split group)
+    char* side = zeros_vector(char, cc.ws_count);
+    partition(lws, cc.ws_count, domains_count, 0, Ds, Ap, Aj, side, tmp);
+
+    free(Ap);
+    free(Aj);
+    free(lws);
+    free(tmp);
+    free(side);
+}
+
+static located_wire* locate(
+    const network_topology nt,
+    const connected_component cc
+)
+{
+    located_wire* lws = vector(located_wire, cc.ws_count);
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        lws[i] = (located_wire) { nt.Ws[cc.ws_skip + i].centroid, i };
+    }
+    return lws;
+}
+
+static void bisect(
+    located_wire lws[],
+    int n,
+    int half,
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[],
+    int* first_count,
+    int* second_count
+)
+{
+    // calculate the bounding box of the centroids in the group
+    double min_x = DBL_MAX, max_x = -DBL_MAX;
+    double min_y = DBL_MAX, max_y = -DBL_MAX;
+    for (int i = 0; i < n; i++)
+    {
+        min_x = lws[i].p.x < min_x ? lws[i].p.x : min_x;
+        max_x = lws[i].p.x > max_x ? lws[i].p.x : max_x;
+        min_y = lws[i].p.y < min_y ? lws[i].p.y : min_y;
+        max_y = lws[i].p.y > max_y ? lws[i].p.y : max_y;
+    }
+
+    // split the group along its widest side; the split is done by count, so
+    // that the halves are balanced also with coincident centroids
+    qsort(lws, n, sizeof(located_wire), max_x - min_x > max_y - min_y ? xcmp : ycmp);
+
+    for (int i = 0; i < n; i++)
+    {
+        side[lws[i].w] = i < half ? 1 : 2;
+    }
+
+    // count the nanowires of each half touching the other half
+    int boundary[3] = { };
+    for (int i = 0; i < n; i++)
+    {
+        boundary[(int)side[lws[i].w]] += on_boundary(lws[i].w, Ap, Aj, side);
+    }
+
+    // the separator is the boundary of the half with less boundary nanowires
+    char separator = boundary[1] <= boundary[2] ? 1 : 2;
+    int separator_count = boundary[(int)separator];
+
+    // count the nanowires remaining in the two halves
+    *first_count = half - (separator == 1 ? separator_count : 0);
+    *second_count = n - separator_count - *first_count;
+
+    // reorder the group as [first half, second half, separator]
+    memcpy(tmp, lws, n * sizeof(located_wire));
+    for (int i = 0, first = 0, second = 0, last = 0; i < n; i++)
+    {
+        int w = tmp[i].w;
+
+        if (side[w] == separator && on_boundary(w, Ap, Aj, side))
+        {
+            lws[n - separator_count + last++] = tmp[i];
+        }
+        else
+        if (side[w] == 1)
+        {
+            lws[first++] = tmp[i];
+        }
+        else
+        {
+            lws[*first_count + second++] = tmp[i];
+        }
+    }
+
+    // reset the markers of the group
+    for (int i = 0; i < n; i++)
+    {
+        side[lws[i].w] = 0;
+    }
+}
+
+static void dissect(
+    located_wire lws[],
+    int n,
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[]
+)
+{
+    // small groups are not worth further dissection
+    if (n <= LEAF_SIZE)
+    {
+        return;
+    }
+
+    // split the group at its median and recursively order the two halves
+    int first_count, second_count;
+    bisect(lws, n, n / 2, Ap, Aj, side, tmp, &first_count, &second_count);
+
+    dissect(lws, first_count, Ap, Aj, side, tmp);
+    dissect(lws + first_count, second_count, Ap, Aj, side, tmp);
+}
+
+static void partition(
+    located_wire lws[],
+    int n,
+    int domains_count,
+    int first_domain,
+    int Ds[],
+    const int Ap[],
+    const int Aj[],
+    char side[],
+    located_wire tmp[]
+)
+{
+    // a single domain contains all the remaining nanowires
+    if (domains_count == 1)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            Ds[lws[i].w] = first_domain;
+        }
+        return;
+    }
+
+    // split the group proportionally to the number of domains in each half
+    int first_domains = domains_count / 2;
+    int first_count, second_count;
+    bisect(
+        lws, n, (int)((long)n * first_domains / domains_count),
+        Ap, Aj, side, tmp, &first_count, &second_count
+    );
+
+    // the separator nanowires belong to the interface
+    for (int i = first_count + second_count; i < n; i++)
+    {
+        Ds[lws[i].w] = -1;
+    }
+
+    partition(
+        lws, first_count, first_domains, first_domain,
+        Ds, Ap, Aj, side, tmp
+    );
+    partition(
+        lws + first_count, second_count, domains_count - first_domains,
+        first_domain + first_domains, Ds, Ap, Aj, side, tmp
+    );
+}
+
+static bool on_boundary(int w, const int Ap[], const int Aj[], const char side[])
+{
+    for (int k = Ap[w]; k < Ap[w + 1]; k++)
+    {
+        if (side[Aj[k]] != 0 && side[Aj[k]] != side[w])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int xcmp(const void* e1, const void* e2)
+{
+    located_wire a = *((located_wire*)e1);
+    located_wire b = *((located_wire*)e2);
+
+    return (a.p.x > b.p.x) - (a.p.x < b.p.x);
+}
+
+static int ycmp(const void* e1, const void* e2)
+{
+    located_wire a = *((located_wire*)e1);
+    located_wire b = *((located_wire*)e2);
+
+    return (a.p.y > b.p.y) - (a.p.y < b.p.y);
+}
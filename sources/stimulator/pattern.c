@@ -0,0 +1,603 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <umfpack.h>
+
+#include "config.h"
+#include "interface/connection.h"
+#include "stimulator/pattern.h"
+#include "util/components.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// add the conductance of the k-th junction to the diagonal of its endpoints
+// and set its off-diagonal entries in the cached MNA system
+static void scatter(mna_pattern mp, int k, double Y);
+
+// set the voltage of the sources in the right-hand side of the system
+static void right_hand_side(
+    const interface it,
+    const double io[],
+    const mna_pattern mp,
+    double b[]
+);
+
+// solve the cached MNA system, reusing its symbolic analysis
+static int solve(const mna_pattern mp, const double b[], double x[]);
+
+// solve the cached MNA system with its numeric factorization
+static int solve_factorized(
+    const mna_pattern mp,
+    void* Numeric,
+    const double b[],
+    double x[]
+);
+
+// calculate the maximum residual of a solution of the cached MNA system,
+// scaled by the diagonal of each row (i.e., in volts)
+static double scaled_residual(
+    const mna_pattern mp,
+    const double b[],
+    const double x[]
+);
+
+// set the voltage of the nanowires and the current drawn by the sources from
+// a solution of the cached MNA system
+static void distribute(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    const double x[]
+);
+
+int create_pattern(
+    const network_state ns,
+    const connected_component cc,
+    const interface it,
+    const mna_settings settings,
+    mna_pattern* mp
+)
+{
+    requires(settings.solver == DIRECT_SOLVER && settings.reduction == NULL, -1, "The cached MNA system supports only the direct solver without reductions!\n");
+
+    // describe the nanowire connection type (default none), and save the
+    // weight of a possible load connected to a nanowire
+    connection_t nct[cc.ws_count] = { };
+    double* ws = zeros_vector(double, cc.ws_count);
+
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            nct[nwi] = SOURCE;
+        }
+    }
+
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            nct[nwi] = GROUND;
+        }
+    }
+
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            nct[nwi] = LOAD;
+            ws[nwi] = it.loads_weight[i];
+        }
+    }
+
+    // number the voltage of the nanowires not grounded, followed by the
+    // current of the sources (in the order of their nanowire, as done by
+    // ::voltage_stimulation)
+    int* n2x = vector(int, cc.ws_count);
+    int size = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        n2x[i] = nct[i] == GROUND ? -1 : size++;
+    }
+
+    int n2s[cc.ws_count];
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        n2s[i] = nct[i] == SOURCE ? size++ : -1;
+    }
+
+    int* s2x = vector(int, it.sources_count + 1);
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        s2x[i] = 0 <= nwi && nwi < cc.ws_count ? n2s[nwi] : -1;
+    }
+
+    // the neighbours of each nanowire are sorted by index, so that the
+    // entries of each column are sorted by row, as required by UMFPACK
+    int Bp[cc.ws_count + 1], Bj[2 * cc.js_count + 1], Bk[2 * cc.js_count + 1];
+    construe_adjacency_lists(cc, Bp, Bj, Bk);
+
+    // count the entries of each column: the diagonal, the neighbours not
+    // grounded, and the possible source marker; a source column has one entry
+    int* Ap = zeros_vector(int, size + 1);
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (nct[i] == GROUND)
+        {
+            continue;
+        }
+
+        int count = 1 + (nct[i] == SOURCE);
+        for (int e = Bp[i]; e < Bp[i + 1]; e++)
+        {
+            count += nct[Bj[e]] != GROUND;
+        }
+        Ap[n2x[i] + 1] = count;
+
+        if (nct[i] == SOURCE)
+        {
+            Ap[n2s[i] + 1] = 1;
+        }
+    }
+
+    for (int x = 0; x < size; x++)
+    {
+        Ap[x + 1] += Ap[x];
+    }
+
+    int* Ai = vector(int, Ap[size] + 1);
+    double* Ax = zeros_vector(double, Ap[size] + 1);
+    int* Jx = vector(int, 4 * cc.js_count + 1);
+    int* Dx = vector(int, cc.ws_count);
+
+    // the entries not in the system (i.e., in the column of a ground) are
+    // marked with a negative number
+    memset(Jx, 0xff, 4 * cc.js_count * sizeof(int));
+    memset(Dx, 0xff, cc.ws_count * sizeof(int));
+
+    // fill the structure of each column, recording the position of the
+    // entries of each junction
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (nct[i] == GROUND)
+        {
+            continue;
+        }
+
+        int p = Ap[n2x[i]];
+        for (int e = Bp[i]; e <= Bp[i + 1]; e++)
+        {
+            // the diagonal precedes the first neighbour with a larger index
+            if (Dx[i] < 0 && (e == Bp[i + 1] || Bj[e] > i))
+            {
+                Dx[i] = p;
+                Ai[p++] = n2x[i];
+            }
+
+            if (e == Bp[i + 1])
+            {
+                break;
+            }
+
+            int j = Bj[e];
+            if (nct[j] != GROUND)
+            {
+                Jx[4 * Bk[e] + (i < j ? 2 : 3)] = p;
+                Ai[p++] = n2x[j];
+            }
+        }
+
+        if (nct[i] == SOURCE)
+        {
+            Ai[p] = n2s[i];
+            Ax[p] = 1;
+            Ai[Ap[n2s[i]]] = n2x[i];
+            Ax[Ap[n2s[i]]] = 1;
+        }
+    }
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        Jx[4 * k + 0] = Dx[cc.Is[k] / cc.ws_count];
+        Jx[4 * k + 1] = Dx[cc.Is[k] % cc.ws_count];
+    }
+
+    *mp = (mna_pattern) { size, Ap, Ai, Ax, Jx, Dx, ws, n2x, s2x, NULL };
+    refill_pattern(ns, cc, *mp);
+
+    // perform the symbolic analysis, translating the ordering of the
+    // nanowires to the columns of the system if given
+    double info[UMFPACK_INFO];
+    if (settings.Qs != NULL)
+    {
+        int Q[size];
+        for (int k = 0, q = 0; k < cc.ws_count; k++)
+        {
+            int i = settings.Qs[k];
+
+            if (nct[i] != GROUND)
+            {
+                Q[q++] = n2x[i];
+            }
+
+            if (nct[i] == SOURCE)
+            {
+                Q[q++] = n2s[i];
+            }
+        }
+        umfpack_di_qsymbolic(size, size, Ap, Ai, Ax, Q, &mp->Symbolic, NULL, info);
+    }
+    else
+    {
+        umfpack_di_symbolic(size, size, Ap, Ai, Ax, &mp->Symbolic, NULL, info);
+    }
+
+    if (info[UMFPACK_STATUS] != UMFPACK_OK)
+    {
+        destroy_pattern(*mp);
+    }
+    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "The symbolic analysis of the MNA system failed! INFO = %f\n", info[UMFPACK_STATUS]);
+
+    return 0;
+}
+
+void refill_pattern(
+    const network_state ns,
+    const connected_component cc,
+    mna_pattern mp
+)
+{
+    // the diagonal of a nanowire starts from the weight of its load
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (mp.Dx[i] >= 0)
+        {
+            mp.Ax[mp.Dx[i]] = mp.ws[i];
+        }
+    }
+
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        scatter(mp, k, ns.Ys[cc.js_skip + k]);
+    }
+}
+
+void fused_update(
+    network_state ns,
+    const connected_component cc,
+    mna_pattern mp
+)
+{
+    // the diagonal of a nanowire starts from the weight of its load
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (mp.Dx[i] >= 0)
+        {
+            mp.Ax[mp.Dx[i]] = mp.ws[i];
+        }
+    }
+
+    // iterate over all the junction indexes
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        // get the index of the wires in the nanowire-network state
+        int i = cc.ws_skip + cc.Is[k] / cc.ws_count;
+        int j = cc.ws_skip + cc.Is[k] % cc.ws_count;
+
+        // calculate the delta voltage on each junction
+        double ΔV = fabs(ns.Vs[i] - ns.Vs[j]);
+
+        // compute the potentiation and depression coefficients
+        double kp = KP * exp(ETA_P * ΔV);
+        double kd = KD * exp(-ETA_D * ΔV);
+        double kpd = kp + kd;
+
+        // calculate the conductance of the junction
+        double g = (ns.Ys[cc.js_skip + k] - Y_MIN) / (Y_MAX - Y_MIN);
+        g = kp / kpd * (1 + kd / kp * g * exp(-TAU * kpd));
+
+        // calculate and set circuit admittance, then scatter it in the system
+        double Y = Y_MIN + g * (Y_MAX - Y_MIN);
+        ns.Ys[cc.js_skip + k] = Y;
+        scatter(mp, k, Y);
+    }
+}
+
+int pattern_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp
+)
+{
+    double b[mp.size], x[mp.size];
+    right_hand_side(it, io, mp, b);
+
+    int result = solve(mp, b, x);
+    requires(result == 0, -1, "The MNA system cannot be solved!\n");
+
+    distribute(ns, cc, it, io, mp, x);
+
+    return 0;
+}
+
+int factorize_pattern(const mna_pattern mp, void** Numeric)
+{
+    double info[UMFPACK_INFO];
+    umfpack_di_numeric(mp.Ap, mp.Ai, mp.Ax, mp.Symbolic, Numeric, NULL, info);
+    if (info[UMFPACK_STATUS] != UMFPACK_OK)
+    {
+        // a singular system still has its numeric object
+        umfpack_di_free_numeric(Numeric);
+    }
+    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "Numeric factorization was unsuccessful! The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+
+    return 0;
+}
+
+int factorized_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    void* Numeric
+)
+{
+    double b[mp.size], x[mp.size];
+    right_hand_side(it, io, mp, b);
+
+    int result = solve_factorized(mp, Numeric, b, x);
+    requires(result == 0, -1, "The MNA system cannot be solved!\n");
+
+    distribute(ns, cc, it, io, mp, x);
+
+    return 0;
+}
+
+void destroy_factorization(void* Numeric)
+{
+    umfpack_di_free_numeric(&Numeric);
+}
+
+predictor create_predictor(const mna_pattern mp, int order, double tolerance)
+{
+    return (predictor) {
+        order < 1 ? 1 : order > 2 ? 2 : order,
+        tolerance,
+        0,
+        0,
+        zeros_vector(int, 3),
+        vector(double, 3 * mp.size + 1),
+        0,
+        0
+    };
+}
+
+int predicted_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    predictor* pr
+)
+{
+    double b[mp.size], x[mp.size];
+    right_hand_side(it, io, mp, b);
+
+    int step = pr->step++;
+
+    // extrapolate the solution from the last solved ones with the Lagrange
+    // polynomial through them, and accept it if it satisfies the system
+    // within the tolerance; the predictions are never used for extrapolation,
+    // so that their errors do not accumulate
+    bool predicted = false;
+    if (pr->history_count > pr->order)
+    {
+        double ws[3] = { };
+        for (int i = 0; i <= pr->order; i++)
+        {
+            ws[i] = 1;
+            for (int j = 0; j <= pr->order; j++)
+            {
+                if (j != i)
+                {
+                    ws[i] *= (double)(step - pr->steps[j]) / (pr->steps[i] - pr->steps[j]);
+                }
+            }
+        }
+
+        #pragma omp parallel for if(mp.size >= parallel_threshold(CIRCUIT_GRAIN))
+        for (int i = 0; i < mp.size; i++)
+        {
+            x[i] = 0;
+            for (int j = 0; j <= pr->order; j++)
+            {
+                x[i] += ws[j] * pr->xs[j * mp.size + i];
+            }
+        }
+
+        predicted = scaled_residual(mp, b, x) <= pr->tolerance;
+    }
+
+    if (predicted)
+    {
+        pr->skips_count++;
+    }
+    else
+    {
+        int result = solve(mp, b, x);
+        requires(result == 0, -1, "The MNA system cannot be solved!\n");
+
+        pr->solves_count++;
+
+        // shift the history of the solutions
+        memmove(pr->xs + mp.size, pr->xs, 2 * mp.size * sizeof(double));
+        memmove(pr->steps + 1, pr->steps, 2 * sizeof(int));
+        memcpy(pr->xs, x, mp.size * sizeof(double));
+        pr->steps[0] = step;
+        pr->history_count += pr->history_count < 3;
+    }
+
+    distribute(ns, cc, it, io, mp, x);
+
+    return 0;
+}
+
+void destroy_predictor(predictor pr)
+{
+    free(pr.steps);
+    free(pr.xs);
+}
+
+void destroy_pattern(mna_pattern mp)
+{
+    if (mp.Symbolic != NULL)
+    {
+        umfpack_di_free_symbolic(&mp.Symbolic);
+    }
+
+    free(mp.Ap);
+    free(mp.Ai);
+    free(mp.Ax);
+    free(mp.Jx);
+    free(mp.Dx);
+    free(mp.ws);
+    free(mp.n2x);
+    free(mp.s2x);
+}
+
+static void scatter(mna_pattern mp, int k, double Y)
+{
+    // the diagonal of a nanowire is shared by all its junctions
+    for (int e = 0; e < 2; e++)
+    {
+        if (mp.Jx[4 * k + e] >= 0)
+        {
+            #pragma omp atomic
+            mp.Ax[mp.Jx[4 * k + e]] += Y;
+        }
+    }
+
+    // the off-diagonal entries belong to the junction only
+    for (int e = 2; e < 4; e++)
+    {
+        if (mp.Jx[4 * k + e] >= 0)
+        {
+            mp.Ax[mp.Jx[4 * k + e]] = - Y;
+        }
+    }
+}
+
+static void right_hand_side(
+    const interface it,
+    const double io[],
+    const mna_pattern mp,
+    double b[]
+)
+{
+    memset(b, 0, mp.size * sizeof(double));
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        if (mp.s2x[i] >= 0)
+        {
+            b[mp.s2x[i]] = io[i];
+        }
+    }
+}
+
+static int solve(const mna_pattern mp, const double b[], double x[])
+{
+    // the symbolic analysis is reused: only the numeric factorization is
+    // performed at each solution
+    void* Numeric;
+    requires(factorize_pattern(mp, &Numeric) == 0, -1, "The MNA system cannot be factorized!\n");
+
+    int result = solve_factorized(mp, Numeric, b, x);
+    destroy_factorization(Numeric);
+
+    return result;
+}
+
+static int solve_factorized(
+    const mna_pattern mp,
+    void* Numeric,
+    const double b[],
+    double x[]
+)
+{
+    double info[UMFPACK_INFO];
+    umfpack_di_solve(UMFPACK_A, mp.Ap, mp.Ai, mp.Ax, x, b, Numeric, NULL, info);
+    requires(info[UMFPACK_STATUS] == UMFPACK_OK, -1, "The MNA system cannot be solved! INFO = %f\n", info[UMFPACK_STATUS]);
+
+    return 0;
+}
+
+static double scaled_residual(
+    const mna_pattern mp,
+    const double b[],
+    const double x[]
+)
+{
+    double residual = 0;
+
+    // the system is symmetric, so each column is also a row: the product of
+    // a row with the solution is computed independently of the others
+    #pragma omp parallel for reduction(max:residual) if(mp.size >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int r = 0; r < mp.size; r++)
+    {
+        double Ax = 0, d = 0;
+        for (int p = mp.Ap[r]; p < mp.Ap[r + 1]; p++)
+        {
+            Ax += mp.Ax[p] * x[mp.Ai[p]];
+            d = mp.Ai[p] == r ? mp.Ax[p] : d;
+        }
+
+        // a source row has no diagonal, and its residual is already a voltage
+        double e = fabs(b[r] - Ax) / (d > 0 ? d : 1);
+        residual = e > residual ? e : residual;
+    }
+
+    return residual;
+}
+
+static void distribute(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    const mna_pattern mp,
+    const double x[]
+)
+{
+    // set the voltages in the ns.Vs array (the grounds are at 0 volts)
+    #pragma omp parallel for if(cc.ws_count >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        ns.Vs[cc.ws_skip + i] = mp.n2x[i] >= 0 ? x[mp.n2x[i]] : 0;
+    }
+
+    // set the value of the source nodes in the voltage array,
+    // and the intensity of the drawn current in the io array
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        ns.Vs[it.sources_index[i]] = io[i];
+
+        if (mp.s2x[i] >= 0)
+        {
+            io[i] = - x[mp.s2x[i]];
+        }
+    }
+}
@@ -0,0 +1,950 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "stimulator/reduction.h"
+#include "util/components.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// state of a junction in the contraction of a CC
+typedef enum
+{
+    KEPT,       // the junction is kept in the contracted CC
+    MERGED,     // the junction is a short-circuit inside a super-node
+    DROPPED     // the junction is an open-circuit
+} contraction_t;
+
+// junction of a CC together with its conductance
+typedef struct
+{
+    double  y;  // conductance of the junction
+    int     k;  // index of the junction in the connected component
+} weighted_junction;
+
+// chain of junctions between two nanowires of the reduced CC
+typedef struct
+{
+    int lo;     // lower index (in the reduced CC) of the chain endpoints
+    int hi;     // higher index (in the reduced CC) of the chain endpoints
+    int start;  // start of the chain in the junctions/nanowires buffers
+    int length; // number of junctions in the chain
+} chain;
+
+// mark the nanowires of a CC referenced by the interface
+static void mark_terminals(
+    const connected_component cc,
+    const interface it,
+    bool terminal[]
+);
+
+// prune the trees without terminals by iteratively removing their leaves;
+// the anchor of a pruned nanowire is the neighbour it was attached to
+static void prune_trees(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const bool terminal[],
+    int anchor[]
+);
+
+// prune the biconnected blocks not lying on a path between two terminals;
+// the anchor of a pruned nanowire is the neighbour closer to a current
+// carrying block
+static void prune_blocks(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const int Ak[],
+    const bool terminal[],
+    int anchor[]
+);
+
+// point the anchor of each nanowire directly to a nanowire anchored to itself
+static void resolve(int anchor[], int n);
+
+// mark the nanowires that are internal to a chain, i.e., the remaining
+// nanowires without terminals and with exactly two remaining neighbours
+static void mark_internals(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const bool terminal[],
+    const int anchor[],
+    bool internal[]
+);
+
+// walk the chain starting from the `k`-th adjacency entry of a nanowire of
+// the reduced CC, and store its junctions and nanowires in the buffers;
+// return the number of junctions in the chain
+static int walk(
+    int k,
+    const int Ap[],
+    const int Aj[],
+    const int Ak[],
+    const int anchor[],
+    const bool internal[],
+    bool used[],
+    int js[],
+    int ws[]
+);
+
+// group the chains between the same endpoints in the junctions of a reduced
+// CC with `ws_count` nanowires
+static reduced_component assemble(
+    const connected_component cc,
+    int ws_count,
+    chain chs[],
+    int chs_count,
+    const int js[],
+    const int ws[],
+    int w2r[],
+    int anchor[]
+);
+
+// find the representative of the set of a nanowire in a union-find structure
+static int find(int sets[], int i);
+
+// compare two chains according to their endpoints and position
+static int chcmp(const void* e1, const void* e2);
+
+// compare two weighted junctions according to their decreasing conductance
+static int wjcmp(const void* e1, const void* e2);
+
+reduced_component reduce_component(
+    const connected_component cc,
+    const interface it,
+    int passes
+)
+{
+    bool terminal[cc.ws_count] = { };
+    mark_terminals(cc, it, terminal);
+
+    int* Ap = vector(int, cc.ws_count + 1);
+    int* Aj = vector(int, 2 * cc.js_count + 1);
+    int* Ak = vector(int, 2 * cc.js_count + 1);
+    construe_adjacency_lists(cc, Ap, Aj, Ak);
+
+    // the anchor of a nanowire is the nanowire it takes the voltage from; the
+    // nanowires anchored to themselves are not pruned
+    int* anchor = vector(int, cc.ws_count);
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        anchor[i] = i;
+    }
+
+    if (passes & DANGLING_TREES)
+    {
+        prune_trees(cc, Ap, Aj, terminal, anchor);
+    }
+
+    if (passes & PASSIVE_BLOCKS)
+    {
+        prune_blocks(cc, Ap, Aj, Ak, terminal, anchor);
+    }
+
+    resolve(anchor, cc.ws_count);
+
+    bool internal[cc.ws_count] = { };
+    if (passes & SERIES_PARALLEL)
+    {
+        mark_internals(cc, Ap, Aj, terminal, anchor, internal);
+    }
+
+    // number the remaining nanowires not internal to a chain in their
+    // original order, so that the reduced CC has sorted junctions
+    int* w2r = vector(int, cc.ws_count);
+    int ws_count = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        w2r[i] = anchor[i] == i && !internal[i] ? ws_count++ : -1;
+    }
+
+    // walk all the chains between the nanowires of the reduced CC; a single
+    // junction between two of them is a chain of length 1
+    bool* used = zeros_vector(bool, cc.js_count + 1);
+    int* js = vector(int, cc.js_count + 1);
+    int* ws = vector(int, cc.js_count + 1);
+    chain* chs = vector(chain, cc.js_count + 1);
+    int chs_count = 0;
+
+    for (int u = 0, start = 0; u < cc.ws_count; u++)
+    {
+        if (w2r[u] < 0)
+        {
+            continue;
+        }
+
+        for (int k = Ap[u]; k < Ap[u + 1]; k++)
+        {
+            if (used[Ak[k]] || anchor[Aj[k]] != Aj[k])
+            {
+                continue;
+            }
+
+            int length = walk(k, Ap, Aj, Ak, anchor, internal, used, js + start, ws + start);
+            int w = ws[start + length - 1];
+
+            // a chain closing on its starting nanowire carries no current, so
+            // its nanowires take the voltage of the starting one
+            if (w == u)
+            {
+                for (int e = 0; e < length - 1; e++)
+                {
+                    anchor[ws[start + e]] = u;
+                }
+                continue;
+            }
+
+            // orient the chain from its endpoint with the lower index
+            if (w2r[w] < w2r[u])
+            {
+                for (int e = 0; e < length / 2; e++)
+                {
+                    int tmp = js[start + e];
+                    js[start + e] = js[start + length - 1 - e];
+                    js[start + length - 1 - e] = tmp;
+                }
+                for (int e = 0; e < (length - 1) / 2; e++)
+                {
+                    int tmp = ws[start + e];
+                    ws[start + e] = ws[start + length - 2 - e];
+                    ws[start + length - 2 - e] = tmp;
+                }
+                ws[start + length - 1] = u;
+            }
+
+            chs[chs_count++] = (chain) {
+                w2r[u] < w2r[w] ? w2r[u] : w2r[w],
+                w2r[u] < w2r[w] ? w2r[w] : w2r[u],
+                start,
+                length
+            };
+            start += length;
+        }
+    }
+
+    // the nanowires of a closed chain may be the anchor of a pruned tree
+    resolve(anchor, cc.ws_count);
+
+    free(Ap);
+    free(Aj);
+    free(Ak);
+    free(used);
+
+    reduced_component rc = assemble(cc, ws_count, chs, chs_count, js, ws, w2r, anchor);
+
+    free(js);
+    free(ws);
+    free(chs);
+
+    return rc;
+}
+
+reduced_component contract_component(
+    const network_state ns,
+    const connected_component cc,
+    const interface it,
+    double merge_tolerance,
+    double drop_tolerance
+)
+{
+    bool terminal[cc.ws_count] = { };
+    mark_terminals(cc, it, terminal);
+
+    // the super-nodes are sets of nanowires; a super-node containing a
+    // terminal is represented by it
+    int* sets = vector(int, cc.ws_count);
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        sets[i] = i;
+    }
+
+    // merge the nanowires joined by a saturated junction; two terminals are
+    // never merged, as they are distinct nodes of the MNA system
+    contraction_t* kinds = zeros_vector(contraction_t, cc.js_count + 1);
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        int a = find(sets, cc.Is[k] / cc.ws_count);
+        int b = find(sets, cc.Is[k] % cc.ws_count);
+
+        if (ns.Ys[cc.js_skip + k] < (1 - merge_tolerance) * Y_MAX || (a != b && terminal[a] && terminal[b]))
+        {
+            continue;
+        }
+
+        kinds[k] = MERGED;
+        if (terminal[b])
+        {
+            sets[a] = b;
+        }
+        else
+        {
+            sets[b] = a;
+        }
+    }
+
+    // drop the weakest junctions between different super-nodes, and join the
+    // super-nodes through the kept junctions (with another union-find)
+    int* links = vector(int, cc.ws_count);
+    bool* wired = vector(bool, cc.ws_count);
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        links[i] = i;
+        wired[i] = terminal[i];
+    }
+
+    weighted_junction* dropped = vector(weighted_junction, cc.js_count + 1);
+    int dropped_count = 0;
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        int a = find(sets, cc.Is[k] / cc.ws_count);
+        int b = find(sets, cc.Is[k] % cc.ws_count);
+
+        if (kinds[k] == MERGED || a == b)
+        {
+            kinds[k] = MERGED;
+            continue;
+        }
+
+        if (ns.Ys[cc.js_skip + k] <= (1 + drop_tolerance) * Y_MIN)
+        {
+            kinds[k] = DROPPED;
+            dropped[dropped_count++] = (weighted_junction) { ns.Ys[cc.js_skip + k], k };
+            continue;
+        }
+
+        a = find(links, a);
+        b = find(links, b);
+        if (a != b)
+        {
+            links[b] = a;
+            wired[a] |= wired[b];
+        }
+    }
+
+    // restore the strongest dropped junctions needed to connect a region
+    // without terminals to the rest of the CC, otherwise its voltage would be
+    // undetermined
+    qsort(dropped, dropped_count, sizeof(weighted_junction), wjcmp);
+    for (int d = 0; d < dropped_count; d++)
+    {
+        int k = dropped[d].k;
+        int a = find(links, find(sets, cc.Is[k] / cc.ws_count));
+        int b = find(links, find(sets, cc.Is[k] % cc.ws_count));
+
+        if (a != b && (!wired[a] || !wired[b]))
+        {
+            kinds[k] = KEPT;
+            links[b] = a;
+            wired[a] |= wired[b];
+        }
+    }
+
+    // the nanowires of a super-node take the voltage of its representative
+    int* anchor = vector(int, cc.ws_count);
+    int* w2r = vector(int, cc.ws_count);
+    int ws_count = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        anchor[i] = find(sets, i);
+        w2r[i] = anchor[i] == i ? ws_count++ : -1;
+    }
+
+    // each kept junction is a chain of length 1 between two super-nodes
+    int* js = vector(int, cc.js_count + 1);
+    int* ws = vector(int, cc.js_count + 1);
+    chain* chs = vector(chain, cc.js_count + 1);
+    int chs_count = 0;
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        if (kinds[k] != KEPT)
+        {
+            continue;
+        }
+
+        int i = cc.Is[k] / cc.ws_count;
+        int j = cc.Is[k] % cc.ws_count;
+        int a = w2r[anchor[i]];
+        int b = w2r[anchor[j]];
+
+        js[chs_count] = k;
+        ws[chs_count] = a < b ? j : i;
+        chs[chs_count] = (chain) { a < b ? a : b, a < b ? b : a, chs_count, 1 };
+        chs_count++;
+    }
+
+    reduced_component rc = assemble(cc, ws_count, chs, chs_count, js, ws, w2r, anchor);
+
+    free(sets);
+    free(kinds);
+    free(links);
+    free(wired);
+    free(dropped);
+    free(js);
+    free(ws);
+    free(chs);
+
+    return rc;
+}
+
+void reduce_state(
+    const network_state ns,
+    const connected_component cc,
+    const reduced_component rc,
+    network_state rs
+)
+{
+    #pragma omp parallel for if(rc.cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int q = 0; q < rc.cc.js_count; q++)
+    {
+        // the terms of a junction are in parallel: sum their conductances
+        rs.Ys[q] = 0;
+        for (int t = rc.Tp[q]; t < rc.Tp[q + 1]; t++)
+        {
+            // the junctions of a term are in series: sum their resistances;
+            // a single junction is copied to preserve its exact value
+            if (rc.Cp[t + 1] - rc.Cp[t] == 1)
+            {
+                rs.Ys[q] += ns.Ys[cc.js_skip + rc.Cj[rc.Cp[t]]];
+                continue;
+            }
+
+            double R = 0;
+            for (int e = rc.Cp[t]; e < rc.Cp[t + 1]; e++)
+            {
+                R += 1 / ns.Ys[cc.js_skip + rc.Cj[e]];
+            }
+            rs.Ys[q] += 1 / R;
+        }
+    }
+}
+
+void expand_state(
+    network_state ns,
+    const connected_component cc,
+    const reduced_component rc,
+    const network_state rs
+)
+{
+    // set the voltage of the nanowires in the reduced CC
+    #pragma omp parallel for if(cc.ws_count >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (rc.w2r[i] >= 0)
+        {
+            ns.Vs[cc.ws_skip + i] = rs.Vs[rc.w2r[i]];
+        }
+    }
+
+    // interpolate the voltage of the nanowires in the chains: the current
+    // flowing through a chain is the same in all its junctions
+    #pragma omp parallel for if(rc.cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int q = 0; q < rc.cc.js_count; q++)
+    {
+        double Va = rs.Vs[rc.cc.Is[q] / rc.cc.ws_count];
+        double Vb = rs.Vs[rc.cc.Is[q] % rc.cc.ws_count];
+
+        for (int t = rc.Tp[q]; t < rc.Tp[q + 1]; t++)
+        {
+            if (rc.Cp[t + 1] - rc.Cp[t] == 1)
+            {
+                continue;
+            }
+
+            double R = 0;
+            for (int e = rc.Cp[t]; e < rc.Cp[t + 1]; e++)
+            {
+                R += 1 / ns.Ys[cc.js_skip + rc.Cj[e]];
+            }
+
+            double I = (Va - Vb) / R, V = Va;
+            for (int e = rc.Cp[t]; e < rc.Cp[t + 1] - 1; e++)
+            {
+                V -= I / ns.Ys[cc.js_skip + rc.Cj[e]];
+                ns.Vs[cc.ws_skip + rc.Cw[e]] = V;
+            }
+        }
+    }
+
+    // set the voltage of the removed nanowires from their anchor
+    #pragma omp parallel for if(cc.ws_count >= parallel_threshold(CIRCUIT_GRAIN))
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (rc.anchor[i] != i)
+        {
+            ns.Vs[cc.ws_skip + i] = ns.Vs[cc.ws_skip + rc.anchor[i]];
+        }
+    }
+}
+
+void destroy_reduction(reduced_component rc)
+{
+    destroy_component(rc.cc);
+    free(rc.w2r);
+    free(rc.anchor);
+    free(rc.Tp);
+    free(rc.Cp);
+    free(rc.Cj);
+    free(rc.Cw);
+}
+
+static void mark_terminals(
+    const connected_component cc,
+    const interface it,
+    bool terminal[]
+)
+{
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            terminal[nwi] = true;
+        }
+    }
+
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            terminal[nwi] = true;
+        }
+    }
+
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            terminal[nwi] = true;
+        }
+    }
+}
+
+static void prune_trees(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const bool terminal[],
+    int anchor[]
+)
+{
+    // the degree of a nanowire counts its remaining neighbours
+    int* degree = vector(int, cc.ws_count);
+    int* leaves = vector(int, cc.ws_count);
+    int leaves_count = 0;
+
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        degree[i] = Ap[i + 1] - Ap[i];
+        if (degree[i] == 1 && !terminal[i])
+        {
+            leaves[leaves_count++] = i;
+        }
+    }
+
+    // each nanowire enters the stack at most once, when its degree drops to 1
+    while (leaves_count > 0)
+    {
+        int i = leaves[--leaves_count];
+
+        // the last neighbour of a leaf may have been pruned in the meantime
+        // (i.e., the tree has been entirely consumed)
+        if (degree[i] != 1)
+        {
+            continue;
+        }
+
+        // find the only remaining neighbour and attach the leaf to it
+        int a = -1;
+        for (int k = Ap[i]; k < Ap[i + 1] && a < 0; k++)
+        {
+            a = anchor[Aj[k]] == Aj[k] ? Aj[k] : -1;
+        }
+
+        anchor[i] = a;
+        degree[i] = 0;
+
+        if (--degree[a] == 1 && !terminal[a])
+        {
+            leaves[leaves_count++] = a;
+        }
+    }
+
+    free(degree);
+    free(leaves);
+}
+
+static void prune_blocks(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const int Ak[],
+    const bool terminal[],
+    int anchor[]
+)
+{
+    // discovery time and low-link of the nanowires in the depth-first search;
+    // pe is the junction a nanowire has been discovered from; next is the
+    // next adjacency entry of a nanowire to explore
+    int* disc = vector(int, cc.ws_count);
+    int* low = vector(int, cc.ws_count);
+    int* pe = vector(int, cc.ws_count);
+    int* next = vector(int, cc.ws_count);
+
+    // acc counts the terminals hanging from a nanowire outside the block
+    // being emitted: the nanowire itself and the blocks headed by it
+    int* acc = vector(int, cc.ws_count);
+    int* stamp = vector(int, cc.ws_count);
+    bool* active = zeros_vector(bool, cc.ws_count);
+
+    int* vs = vector(int, cc.ws_count);
+    int* es = vector(int, cc.js_count + 1);
+    int vs_count = 0, es_count = 0, time = 0, terminals_count = 0;
+
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        disc[i] = -1;
+        stamp[i] = -1;
+        acc[i] = terminal[i];
+        terminals_count += terminal[i];
+    }
+
+    // start the search from a remaining nanowire; the remaining nanowires
+    // are connected, so a single search visits all of them
+    int root = 0;
+    while (anchor[root] != root)
+    {
+        root++;
+    }
+
+    disc[root] = low[root] = time++;
+    next[root] = Ap[root];
+    pe[root] = -1;
+    vs[vs_count++] = root;
+
+    int blocks_count = 0;
+    while (vs_count > 0)
+    {
+        int v = vs[vs_count - 1];
+
+        // explore the next junction of the nanowire
+        if (next[v] < Ap[v + 1])
+        {
+            int k = next[v]++;
+            int w = Aj[k];
+
+            if (anchor[w] != w || Ak[k] == pe[v])
+            {
+                continue;
+            }
+
+            if (disc[w] < 0)
+            {
+                es[es_count++] = Ak[k];
+                disc[w] = low[w] = time++;
+                next[w] = Ap[w];
+                pe[w] = Ak[k];
+                vs[vs_count++] = w;
+            }
+            else
+            if (disc[w] < disc[v])
+            {
+                es[es_count++] = Ak[k];
+                low[v] = disc[w] < low[v] ? disc[w] : low[v];
+            }
+            continue;
+        }
+
+        // the nanowire is complete: propagate its low-link to the parent
+        vs_count--;
+        if (pe[v] < 0)
+        {
+            continue;
+        }
+
+        int p = cc.Is[pe[v]] / cc.ws_count;
+        p = p == v ? cc.Is[pe[v]] % cc.ws_count : p;
+        low[p] = low[v] < low[p] ? low[v] : low[p];
+
+        if (low[v] < disc[p])
+        {
+            continue;
+        }
+
+        // p heads a block: pop its junctions and count the terminals hanging
+        // from its nanowires other than p; the junction from p to v is the
+        // first pushed of the block
+        int hanging = 0, sides = 0, e = es_count;
+        do
+        {
+            e--;
+            int i = cc.Is[es[e]] / cc.ws_count;
+            int j = cc.Is[es[e]] % cc.ws_count;
+
+            for (int u = i, h = 0; h < 2; u = j, h++)
+            {
+                if (u != p && stamp[u] != blocks_count)
+                {
+                    stamp[u] = blocks_count;
+                    hanging += acc[u];
+                    sides += acc[u] > 0;
+                }
+            }
+        }
+        while (es[e] != pe[v]);
+
+        // the block carries current if the terminals hang from at least two
+        // of its nanowires (p hangs on the rest of the CC)
+        sides += terminals_count - hanging > 0;
+        for (int h = e; sides >= 2 && h < es_count; h++)
+        {
+            active[cc.Is[es[h]] / cc.ws_count] = true;
+            active[cc.Is[es[h]] % cc.ws_count] = true;
+        }
+
+        acc[p] += hanging;
+        es_count = e;
+        blocks_count++;
+    }
+
+    // without any current-carrying block, the CC is reduced to a terminal
+    // (or to its first nanowire)
+    bool any = false;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        any |= active[i];
+    }
+
+    if (!any)
+    {
+        int r = root;
+        for (int i = 0; i < cc.ws_count; i++)
+        {
+            if (anchor[i] == i && terminal[i])
+            {
+                r = i;
+                break;
+            }
+        }
+        active[r] = true;
+    }
+
+    // anchor the nanowires of the passive blocks to the current-carrying ones
+    // with a breadth-first search; a passive region hangs from a single
+    // articulation nanowire, so any path to it is equivalent
+    int* queue = vector(int, cc.ws_count);
+    bool* visited = vector(bool, cc.ws_count);
+    int head = 0, tail = 0;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        visited[i] = anchor[i] != i || active[i];
+        if (anchor[i] == i && active[i])
+        {
+            queue[tail++] = i;
+        }
+    }
+
+    while (head < tail)
+    {
+        int u = queue[head++];
+        for (int k = Ap[u]; k < Ap[u + 1]; k++)
+        {
+            if (!visited[Aj[k]])
+            {
+                visited[Aj[k]] = true;
+                anchor[Aj[k]] = u;
+                queue[tail++] = Aj[k];
+            }
+        }
+    }
+
+    free(disc);
+    free(low);
+    free(pe);
+    free(next);
+    free(acc);
+    free(stamp);
+    free(active);
+    free(vs);
+    free(es);
+    free(queue);
+    free(visited);
+}
+
+static void resolve(int anchor[], int n)
+{
+    // the anchors point to nanowires removed later, so they are not cyclic
+    for (int i = 0; i < n; i++)
+    {
+        int a = i;
+        while (anchor[a] != a)
+        {
+            a = anchor[a];
+        }
+        anchor[i] = a;
+    }
+}
+
+static void mark_internals(
+    const connected_component cc,
+    const int Ap[],
+    const int Aj[],
+    const bool terminal[],
+    const int anchor[],
+    bool internal[]
+)
+{
+    bool hub = false;
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        if (anchor[i] != i)
+        {
+            continue;
+        }
+
+        int degree = 0;
+        for (int k = Ap[i]; k < Ap[i + 1]; k++)
+        {
+            degree += anchor[Aj[k]] == Aj[k];
+        }
+
+        internal[i] = degree == 2 && !terminal[i];
+        hub |= !internal[i];
+    }
+
+    // a cycle of internal nanowires has no endpoint to collapse on; it can
+    // only be the whole CC, which is then left unreduced
+    if (!hub)
+    {
+        memset(internal, 0, cc.ws_count * sizeof(bool));
+    }
+}
+
+static int walk(
+    int k,
+    const int Ap[],
+    const int Aj[],
+    const int Ak[],
+    const int anchor[],
+    const bool internal[],
+    bool used[],
+    int js[],
+    int ws[]
+)
+{
+    int length = 0;
+    int v = Aj[k];
+
+    used[Ak[k]] = true;
+    js[length] = Ak[k];
+    ws[length++] = v;
+
+    // cross the internal nanowires through their other unused junction
+    while (internal[v])
+    {
+        int next = -1;
+        for (int h = Ap[v]; h < Ap[v + 1] && next < 0; h++)
+        {
+            if (!used[Ak[h]] && anchor[Aj[h]] == Aj[h])
+            {
+                next = h;
+            }
+        }
+
+        used[Ak[next]] = true;
+        js[length] = Ak[next];
+        ws[length++] = v = Aj[next];
+    }
+
+    return length;
+}
+
+static reduced_component assemble(
+    const connected_component cc,
+    int ws_count,
+    chain chs[],
+    int chs_count,
+    const int js[],
+    const int ws[],
+    int w2r[],
+    int anchor[]
+)
+{
+    // group the chains between the same endpoints in a single junction
+    qsort(chs, chs_count, sizeof(chain), chcmp);
+
+    int* Is = vector(int, chs_count + 1);
+    int* Tp = vector(int, chs_count + 1);
+    int* Cp = vector(int, chs_count + 1);
+    int* Cj = vector(int, cc.js_count + 1);
+    int* Cw = vector(int, cc.js_count + 1);
+    int js_count = 0;
+
+    Cp[0] = 0;
+    for (int t = 0; t < chs_count; t++)
+    {
+        if (t == 0 || chs[t].lo != chs[t - 1].lo || chs[t].hi != chs[t - 1].hi)
+        {
+            Is[js_count] = chs[t].lo * ws_count + chs[t].hi;
+            Tp[js_count++] = t;
+        }
+
+        Cp[t + 1] = Cp[t] + chs[t].length;
+        for (int e = 0; e < chs[t].length; e++)
+        {
+            Cj[Cp[t] + e] = js[chs[t].start + e];
+            Cw[Cp[t] + e] = ws[chs[t].start + e];
+        }
+    }
+    Tp[js_count] = chs_count;
+
+    return (reduced_component) {
+        (connected_component) { ws_count, js_count, 0, 0, Is },
+        w2r,
+        anchor,
+        Tp,
+        Cp,
+        Cj,
+        Cw
+    };
+}
+
+static int find(int sets[], int i)
+{
+    // halve the path to the representative while looking for it
+    while (sets[i] != i)
+    {
+        sets[i] = sets[sets[i]];
+        i = sets[i];
+    }
+    return i;
+}
+
+static int chcmp(const void* e1, const void* e2)
+{
+    chain a = *((chain*)e1);
+    chain b = *((chain*)e2);
+
+    if (a.lo != b.lo)
+    {
+        return a.lo - b.lo;
+    }
+    if (a.hi != b.hi)
+    {
+        return a.hi - b.hi;
+    }
+    return a.start - b.start;
+}
+
+static int wjcmp(const void* e1, const void* e2)
+{
+    weighted_junction a = *((weighted_junction*)e1);
+    weighted_junction b = *((weighted_junction*)e2);
+
+    return (a.y < b.y) - (a.y > b.y);
+}
@@ -0,0 +1,400 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <umfpack.h>
+
+#include "stimulator/schur.h"
+#include "util/errors.h"
+#include "util/tensors.h"
+
+// factorized subdomain of the system in compressed-column form
+typedef struct
+{
+    int     n;          // number of unknowns in the subdomain
+    int*    Dp;         // column pointers of A_dd
+    int*    Di;         // row indexes of A_dd
+    double* Dx;         // values of A_dd
+    void*   Numeric;    // UMFPACK factorization of A_dd
+} subdomain;
+
+// extract and factorize the A_dd block of the `n` unknowns `ds` of the
+// subdomain `d`; return false if the factorization fails
+static bool factorize(
+    const int Ap[],
+    const int Ai[],
+    const double Ax[],
+    const int dom[],
+    const int loc[],
+    const int ds[],
+    int n,
+    int d,
+    subdomain* sd
+);
+
+// free the memory of a subdomain
+static void release(subdomain sd);
+
+int schur_solve(
+    int size,
+    const int Ap[],
+    const int Ai[],
+    const double Ax[],
+    double x[],
+    const double b[],
+    const int dom[],
+    int domains_count
+)
+{
+    // check that the subdomains are coupled only through the interface
+    for (int u = 0; u < size; u++)
+    {
+        for (int k = Ap[u]; k < Ap[u + 1]; k++)
+        {
+            requires(
+                dom[u] < 0 || dom[Ai[k]] < 0 || dom[u] == dom[Ai[k]], -1,
+                "The subdomains %d and %d are directly coupled!\n", dom[u], dom[Ai[k]]
+            );
+        }
+    }
+
+    // calculate the index of each unknown in its part (i.e., subdomain or
+    // interface) and the size of each part; the interface is the last part
+    int* loc = vector(int, size);
+    int* counts = zeros_vector(int, domains_count + 1);
+    for (int u = 0; u < size; u++)
+    {
+        int d = dom[u] < 0 ? domains_count : dom[u];
+        loc[u] = counts[d]++;
+    }
+
+    // list the unknowns of each part contiguously
+    int* starts = zeros_vector(int, domains_count + 2);
+    for (int d = 0; d <= domains_count; d++)
+    {
+        starts[d + 1] = starts[d] + counts[d];
+    }
+
+    int* us = vector(int, size);
+    for (int u = 0; u < size; u++)
+    {
+        us[starts[dom[u] < 0 ? domains_count : dom[u]] + loc[u]] = u;
+    }
+
+    // the interface unknowns and their number
+    const int* γs = us + starts[domains_count];
+    int m = counts[domains_count];
+
+    // create the (column-major) Schur complement of the interface and its
+    // right-hand side, initialized with A_ΓΓ and b_Γ
+    double* S = zeros_vector(double, (size_t)m * m + 1);
+    double* bΓ = vector(double, m + 1);
+    for (int c = 0; c < m; c++)
+    {
+        bΓ[c] = b[γs[c]];
+        for (int k = Ap[γs[c]]; k < Ap[γs[c] + 1]; k++)
+        {
+            if (dom[Ai[k]] < 0)
+            {
+                S[(size_t)c * m + loc[Ai[k]]] += Ax[k];
+            }
+        }
+    }
+
+    subdomain* sds = zeros_vector(subdomain, domains_count);
+    bool failed = false;
+
+    // factorize the subdomains and condense them into the interface
+    #pragma omp parallel for schedule(dynamic)
+    for (int d = 0; d < domains_count; d++)
+    {
+        int n = counts[d];
+        const int* ds = us + starts[d];
+        double info[UMFPACK_INFO];
+
+        if (n == 0)
+        {
+            continue;
+        }
+
+        if (!factorize(Ap, Ai, Ax, dom, loc, ds, n, d, &sds[d]))
+        {
+            #pragma omp atomic write
+            failed = true;
+            continue;
+        }
+
+        // list the entries of A_Γd, i.e., the coupling of the subdomain
+        // columns with the interface rows
+        int es_count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            for (int k = Ap[ds[i]]; k < Ap[ds[i] + 1]; k++)
+            {
+                es_count += dom[Ai[k]] < 0;
+            }
+        }
+
+        int* es_column = vector(int, es_count + 1);
+        int* es_row = vector(int, es_count + 1);
+        double* es_value = vector(double, es_count + 1);
+        for (int i = 0, e = 0; i < n; i++)
+        {
+            for (int k = Ap[ds[i]]; k < Ap[ds[i] + 1]; k++)
+            {
+                if (dom[Ai[k]] < 0)
+                {
+                    es_column[e] = i;
+                    es_row[e] = loc[Ai[k]];
+                    es_value[e++] = Ax[k];
+                }
+            }
+        }
+
+        double* r = vector(double, n);
+        double* y = vector(double, n);
+        double* t = vector(double, m + 1);
+
+        // condense the right-hand side: b_Γ -= A_Γd * A_dd^-1 * b_d
+        for (int i = 0; i < n; i++)
+        {
+            r[i] = b[ds[i]];
+        }
+        umfpack_di_solve(UMFPACK_A, sds[d].Dp, sds[d].Di, sds[d].Dx, y, r, sds[d].Numeric, NULL, info);
+
+        memset(t, 0, m * sizeof(double));
+        for (int e = 0; e < es_count; e++)
+        {
+            t[es_row[e]] += es_value[e] * y[es_column[e]];
+        }
+
+        // t is reset while consumed, so that the interface rows repeated in
+        // A_Γd are subtracted only once
+        #pragma omp critical
+        for (int e = 0; e < es_count; e++)
+        {
+            bΓ[es_row[e]] -= t[es_row[e]];
+            t[es_row[e]] = 0;
+        }
+
+        // condense the interface columns touching the subdomain:
+        // S[:, c] -= A_Γd * A_dd^-1 * A_dc
+        for (int c = 0; c < m; c++)
+        {
+            bool touches = false;
+            memset(r, 0, n * sizeof(double));
+            for (int k = Ap[γs[c]]; k < Ap[γs[c] + 1]; k++)
+            {
+                if (dom[Ai[k]] == d)
+                {
+                    r[loc[Ai[k]]] = Ax[k];
+                    touches = true;
+                }
+            }
+
+            if (!touches)
+            {
+                continue;
+            }
+
+            umfpack_di_solve(UMFPACK_A, sds[d].Dp, sds[d].Di, sds[d].Dx, y, r, sds[d].Numeric, NULL, info);
+
+            for (int e = 0; e < es_count; e++)
+            {
+                t[es_row[e]] += es_value[e] * y[es_column[e]];
+            }
+
+            #pragma omp critical
+            for (int e = 0; e < es_count; e++)
+            {
+                S[(size_t)c * m + es_row[e]] -= t[es_row[e]];
+                t[es_row[e]] = 0;
+            }
+        }
+
+        free(es_column);
+        free(es_row);
+        free(es_value);
+        free(r);
+        free(y);
+        free(t);
+    }
+
+    // solve the Schur complement system for the interface unknowns
+    double* xΓ = vector(double, m + 1);
+    if (!failed && m > 0)
+    {
+        // convert the Schur complement to compressed-column form
+        int* Sp = vector(int, m + 1);
+        int* Si = vector(int, (size_t)m * m);
+        double* Sx = vector(double, (size_t)m * m);
+
+        Sp[0] = 0;
+        for (int c = 0; c < m; c++)
+        {
+            Sp[c + 1] = Sp[c];
+            for (int r = 0; r < m; r++)
+            {
+                if (S[(size_t)c * m + r] != 0 || r == c)
+                {
+                    Si[Sp[c + 1]] = r;
+                    Sx[Sp[c + 1]++] = S[(size_t)c * m + r];
+                }
+            }
+        }
+
+        double info[UMFPACK_INFO];
+        void *Symbolic = NULL, *Numeric = NULL;
+
+        umfpack_di_symbolic(m, m, Sp, Si, Sx, &Symbolic, NULL, info);
+        failed = info[UMFPACK_STATUS] != UMFPACK_OK;
+
+        if (!failed)
+        {
+            umfpack_di_numeric(Sp, Si, Sx, Symbolic, &Numeric, NULL, info);
+            failed = info[UMFPACK_STATUS] != UMFPACK_OK;
+            umfpack_di_free_symbolic(&Symbolic);
+        }
+
+        if (!failed)
+        {
+            umfpack_di_solve(UMFPACK_A, Sp, Si, Sx, xΓ, bΓ, Numeric, NULL, info);
+            failed = info[UMFPACK_STATUS] != UMFPACK_OK;
+        }
+        umfpack_di_free_numeric(&Numeric);
+
+        free(Sp);
+        free(Si);
+        free(Sx);
+    }
+
+    // back-substitute the interface solution in the subdomains:
+    // x_d = A_dd^-1 * (b_d - A_dΓ * x_Γ)
+    #pragma omp parallel for schedule(dynamic)
+    for (int d = 0; d < domains_count; d++)
+    {
+        if (failed || counts[d] == 0)
+        {
+            continue;
+        }
+
+        int n = counts[d];
+        const int* ds = us + starts[d];
+        double info[UMFPACK_INFO];
+
+        double* r = vector(double, n);
+        double* y = vector(double, n);
+        for (int i = 0; i < n; i++)
+        {
+            r[i] = b[ds[i]];
+        }
+
+        for (int c = 0; c < m; c++)
+        {
+            for (int k = Ap[γs[c]]; k < Ap[γs[c] + 1]; k++)
+            {
+                if (dom[Ai[k]] == d)
+                {
+                    r[loc[Ai[k]]] -= Ax[k] * xΓ[c];
+                }
+            }
+        }
+
+        umfpack_di_solve(UMFPACK_A, sds[d].Dp, sds[d].Di, sds[d].Dx, y, r, sds[d].Numeric, NULL, info);
+
+        for (int i = 0; i < n; i++)
+        {
+            x[ds[i]] = y[i];
+        }
+
+        free(r);
+        free(y);
+    }
+
+    for (int c = 0; c < m && !failed; c++)
+    {
+        x[γs[c]] = xΓ[c];
+    }
+
+    for (int d = 0; d < domains_count; d++)
+    {
+        release(sds[d]);
+    }
+
+    free(loc);
+    free(counts);
+    free(starts);
+    free(us);
+    free(S);
+    free(bΓ);
+    free(xΓ);
+    free(sds);
+
+    requires(!failed, -1, "The domain-decomposed system cannot be solved!\n");
+
+    return 0;
+}
+
+static bool factorize(
+    const int Ap[],
+    const int Ai[],
+    const double Ax[],
+    const int dom[],
+    const int loc[],
+    const int ds[],
+    int n,
+    int d,
+    subdomain* sd
+)
+{
+    sd->n = n;
+    sd->Dp = vector(int, n + 1);
+
+    // count the entries of each column of A_dd
+    sd->Dp[0] = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sd->Dp[i + 1] = sd->Dp[i];
+        for (int k = Ap[ds[i]]; k < Ap[ds[i] + 1]; k++)
+        {
+            sd->Dp[i + 1] += dom[Ai[k]] == d;
+        }
+    }
+
+    // copy the entries of A_dd; the rows remain sorted since the local index
+    // of the unknowns follows their order in the system
+    sd->Di = vector(int, sd->Dp[n] + 1);
+    sd->Dx = vector(double, sd->Dp[n] + 1);
+    for (int i = 0, e = 0; i < n; i++)
+    {
+        for (int k = Ap[ds[i]]; k < Ap[ds[i] + 1]; k++)
+        {
+            if (dom[Ai[k]] == d)
+            {
+                sd->Di[e] = loc[Ai[k]];
+                sd->Dx[e++] = Ax[k];
+            }
+        }
+    }
+
+    double info[UMFPACK_INFO];
+    void* Symbolic;
+
+    umfpack_di_symbolic(n, n, sd->Dp, sd->Di, sd->Dx, &Symbolic, NULL, info);
+    if (info[UMFPACK_STATUS] != UMFPACK_OK)
+    {
+        return false;
+    }
+
+    umfpack_di_numeric(sd->Dp, sd->Di, sd->Dx, Symbolic, &sd->Numeric, NULL, info);
+    umfpack_di_free_symbolic(&Symbolic);
+
+    return info[UMFPACK_STATUS] == UMFPACK_OK;
+}
+
+static void release(subdomain sd)
+{
+    free(sd.Dp);
+    free(sd.Di);
+    free(sd.Dx);
+    umfpack_di_free_numeric(&sd.Numeric);
+}
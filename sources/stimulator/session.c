@@ -0,0 +1,123 @@
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "stimulator/session.h"
+#include "stimulator/update.h"
+#include "util/errors.h"
+
+// context of the calling thread, replaced while a session operates
+typedef struct
+{
+    char*   buffer;         // buffer of the error messages of the thread
+    int     threads_count;  // number of threads of its parallel regions
+} context;
+
+// redirect the errors of the calling thread to the session, and limit its
+// parallel regions to the thread budget of the session
+static context enter(session* s);
+
+// restore the context of the calling thread
+static void leave(const context c);
+
+int create_session(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    const mna_settings settings,
+    int threads_count,
+    session* s
+)
+{
+    *s = (session){ ns, cc, it, settings, threads_count < 1 ? 1 : threads_count, false, { }, "" };
+
+    // the system is cached only with the settings supported by the pattern
+    if (settings.solver != DIRECT_SOLVER || settings.reduction != NULL)
+    {
+        return 0;
+    }
+
+    context c = enter(s);
+    int result = create_pattern(ns, cc, it, settings, &s->mp);
+    leave(c);
+
+    s->cached = result == 0;
+
+    return result;
+}
+
+int session_stimulation(session* s, double io[])
+{
+    context c = enter(s);
+
+    int result;
+    if (s->cached)
+    {
+        // the conductance may have been modified out of the session
+        refill_pattern(s->ns, s->cc, s->mp);
+        result = pattern_stimulation(s->ns, s->cc, s->it, io, s->mp);
+    }
+    else
+    {
+        result = voltage_stimulation_with(s->ns, s->cc, s->it, io, s->settings);
+    }
+
+    leave(c);
+
+    return result;
+}
+
+int session_step(session* s, double io[])
+{
+    context c = enter(s);
+
+    int result;
+    if (s->cached)
+    {
+        // the update refills the cached system in the same pass
+        fused_update(s->ns, s->cc, s->mp);
+        result = pattern_stimulation(s->ns, s->cc, s->it, io, s->mp);
+    }
+    else
+    {
+        update_conductance(s->ns, s->cc);
+        result = voltage_stimulation_with(s->ns, s->cc, s->it, io, s->settings);
+    }
+
+    leave(c);
+
+    return result;
+}
+
+void destroy_session(session s)
+{
+    if (s.cached)
+    {
+        destroy_pattern(s.mp);
+    }
+}
+
+static context enter(session* s)
+{
+    s->error[0] = '\0';
+
+    context c = { redirect_errors(s->error), 1 };
+
+#ifdef _OPENMP
+    // the number of threads is an internal control variable of the calling
+    // thread: it does not affect the sessions driven by other threads
+    c.threads_count = omp_get_max_threads();
+    omp_set_num_threads(s->threads_count);
+#endif
+
+    return c;
+}
+
+static void leave(const context c)
+{
+    redirect_errors(c.buffer);
+
+#ifdef _OPENMP
+    omp_set_num_threads(c.threads_count);
+#endif
+}
@@ -0,0 +1,700 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "stimulator/stepping.h"
+#include "stimulator/update.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// smallest time step allowed to the adaptive driver, to guarantee progress
+#define MIN_STEP (TAU * 1e-6)
+
+// number of past iterates mixed by the Anderson acceleration
+#define ANDERSON_DEPTH 5
+
+// steps of relaxation of the conductance in an iteration of the fixed point
+#define RELAXATION_STEPS 16
+
+// junctions of a component above which its update is split among the threads
+#define SPLIT_JUNCTIONS 1024
+
+// propagate the state of a CC through the steps [from, to) of a protocol,
+// with a stimulation every `ratio` steps; a unitary ratio is the exact
+// stepping, and sets the currents drawn by the sources (if ios is not NULL)
+static int propagate(
+    network_state ls,
+    const connected_component lcc,
+    const interface lit,
+    const int l2s[],
+    const double inputs[],
+    double ios[],
+    int sources_count,
+    int from,
+    int to,
+    int ratio,
+    const mna_settings settings
+);
+
+// restrict an interface to the nanowires of a CC, saving the index in the
+// interface of each of its sources
+static interface restrict_interface(
+    const interface it,
+    const connected_component cc,
+    int s2i[]
+);
+
+// find the coefficients γ minimizing |f - dFs γ| by solving the normal
+// equations of the least squares problem; return false if singular
+static bool mixing_coefficients(
+    const double dFs[],
+    const double f[],
+    int n,
+    int depth,
+    double γ[]
+);
+
+int adaptive_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    double duration,
+    double tolerance,
+    const mna_settings settings
+)
+{
+    // the io array is overwritten by each stimulation: save the voltages
+    double vs[it.sources_count + 1];
+    memcpy(vs, io, it.sources_count * sizeof(double));
+
+    int stimulations_count = 0;
+    for (double t = 0; t < duration; stimulations_count++)
+    {
+        memcpy(io, vs, it.sources_count * sizeof(double));
+
+        int result = voltage_stimulation_with(ns, cc, it, io, settings);
+        requires(result == 0, -1, "The adaptive stimulation failed at time %f!\n", t);
+
+        // take the largest step within the tolerance, without exceeding the
+        // end of the interval
+        double dt = conductance_step(ns, cc, tolerance);
+        dt = dt < MIN_STEP ? MIN_STEP : dt;
+        dt = dt < duration - t ? dt : duration - t;
+
+        update_conductance_dt(ns, cc, dt);
+        t += dt;
+    }
+
+    // set the voltage distribution and the currents of the final state
+    memcpy(io, vs, it.sources_count * sizeof(double));
+
+    int result = voltage_stimulation_with(ns, cc, it, io, settings);
+    requires(result == 0, -1, "The adaptive stimulation failed at time %f!\n", duration);
+
+    return stimulations_count + 1;
+}
+
+int steady_state(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double io[],
+    double tolerance,
+    int max_iterations,
+    const mna_settings settings
+)
+{
+    int n = cc.js_count;
+    double* Ys = ns.Ys + cc.js_skip;
+
+    // the io array is overwritten by each stimulation: save the voltages
+    double vs[it.sources_count + 1];
+    memcpy(vs, io, it.sources_count * sizeof(double));
+
+    // the image of the current iterate through the fixed point map, its
+    // residual, and the differences of the last iterates and residuals
+    double* Gs = vector(double, n + 1);
+    double* Fs = zeros_vector(double, n + 1);
+    double* dXs = vector(double, ANDERSON_DEPTH * n + 1);
+    double* dFs = vector(double, ANDERSON_DEPTH * n + 1);
+    double γ[ANDERSON_DEPTH];
+
+    int depth = 0, iteration = 0, result = 0;
+    double residual = INFINITY, last_residual = INFINITY;
+    while (iteration < max_iterations && result == 0)
+    {
+        memcpy(io, vs, it.sources_count * sizeof(double));
+        result = voltage_stimulation_with(ns, cc, it, io, settings);
+        iteration++;
+
+        // the distance of each junction from its equilibrium under the
+        // current voltages measures the convergence
+        equilibrium_conductance(ns, cc, Gs);
+
+        last_residual = residual;
+        residual = 0;
+        for (int k = 0; k < n; k++)
+        {
+            double f = fabs(Gs[k] - Ys[k]);
+            residual = f > residual ? f : residual;
+        }
+        residual /= Y_MAX - Y_MIN;
+
+        if (residual <= tolerance || result != 0)
+        {
+            break;
+        }
+
+        // the image of the iterate is the conductance after some steps of
+        // relaxation at the current voltages: a long relaxation (i.e., the
+        // equilibrium itself) is not a contraction when the voltages adapt
+        memcpy(Gs, Ys, n * sizeof(double));
+        advance_conductance(ns, cc, RELAXATION_STEPS);
+
+        for (int k = 0; k < n; k++)
+        {
+            double f = Ys[k] - Gs[k];
+            Gs[k] = Ys[k];
+            Ys[k] -= f;
+
+            // the newest differences are in the first column
+            dFs[k] = f - Fs[k];
+            Fs[k] = f;
+        }
+
+        // restart the mixing when the iteration diverges; otherwise, add the
+        // last differences to the history
+        depth = iteration == 1 || residual > last_residual ? 0 : depth + (depth < ANDERSON_DEPTH);
+
+        // mix the last iterates to minimize the residual, and take the step
+        // from the image of the combined iterate
+        int mixed = depth > 0 && mixing_coefficients(dFs, Fs, n, depth, γ);
+
+        #pragma omp parallel for if(n >= parallel_threshold(CIRCUIT_GRAIN))
+        for (int k = 0; k < n; k++)
+        {
+            double Y = Gs[k];
+            for (int j = 0; mixed && j < depth; j++)
+            {
+                Y -= γ[j] * (dXs[j * n + k] + dFs[j * n + k]);
+            }
+            Y = Y < Y_MIN ? Y_MIN : Y > Y_MAX ? Y_MAX : Y;
+
+            // shift the history, then save the last step in it
+            for (int j = ANDERSON_DEPTH - 1; j > 0; j--)
+            {
+                dXs[j * n + k] = dXs[(j - 1) * n + k];
+                dFs[j * n + k] = dFs[(j - 1) * n + k];
+            }
+            dXs[k] = Y - Ys[k];
+            Ys[k] = Y;
+        }
+    }
+
+    free(Gs);
+    free(Fs);
+    free(dXs);
+    free(dFs);
+
+    requires(result == 0, -1, "The steady state stimulation failed!\n");
+    requires(residual <= tolerance, -1, "The steady state did not converge in %d iterations!\n", max_iterations);
+
+    return iteration;
+}
+
+int steady_sweep(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    int points_count,
+    double tolerance,
+    int max_iterations,
+    const mna_settings settings
+)
+{
+    int n = cc.js_count;
+    double* Ys = ns.Ys + cc.js_skip;
+
+    // the steady state of the previous point, for the secant extrapolation
+    double* last_Ys = vector(double, n + 1);
+
+    int stimulations_count = 0;
+    for (int p = 0; p < points_count; p++)
+    {
+        // extrapolate the initial guess from the last two steady states
+        #pragma omp parallel for if(n >= parallel_threshold(CIRCUIT_GRAIN))
+        for (int k = 0; k < n; k++)
+        {
+            double Y = p > 1 ? 2 * Ys[k] - last_Ys[k] : Ys[k];
+            last_Ys[k] = Ys[k];
+            Ys[k] = Y < Y_MIN ? Y_MIN : Y > Y_MAX ? Y_MAX : Y;
+        }
+
+        int result = steady_state(ns, cc, it, ios + p * it.sources_count, tolerance, max_iterations, settings);
+        if (result < 0)
+        {
+            free(last_Ys);
+        }
+        requires(result >= 0, -1, "The steady state of the point %d cannot be found!\n", p);
+
+        stimulations_count += result;
+    }
+
+    free(last_Ys);
+
+    return stimulations_count;
+}
+
+int parareal_stimulation(
+    network_state ns,
+    const connected_component cc,
+    const interface it,
+    double ios[],
+    int steps,
+    const mna_settings settings,
+    const parareal_settings ps
+)
+{
+    int S = ps.slices_count < steps ? ps.slices_count : steps;
+    int n = cc.js_count, m = cc.ws_count;
+
+    // each slice works on a private copy of the CC: create an interface
+    // referring to its nanowires (i.e., with ws_skip = 0), where l2s maps
+    // each local source to its entry in the io rows
+    int sources[it.sources_count + 1], l2s[it.sources_count + 1];
+    int grounds[it.grounds_count + 1], loads[it.loads_count + 1];
+    double weights[it.loads_count + 1];
+    interface lit = { 0, sources, 0, grounds, 0, loads, weights };
+    connected_component lcc = { cc.ws_count, cc.js_count, 0, 0, cc.Is };
+
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            l2s[lit.sources_count] = i;
+            sources[lit.sources_count++] = nwi;
+        }
+    }
+
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            grounds[lit.grounds_count++] = nwi;
+        }
+    }
+
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            weights[lit.loads_count] = it.loads_weight[i];
+            loads[lit.loads_count++] = nwi;
+        }
+    }
+
+    // the ios rows are overwritten by the currents: save the voltages
+    double* inputs = vector(double, (size_t)steps * it.sources_count + 1);
+    memcpy(inputs, ios, (size_t)steps * it.sources_count * sizeof(double));
+
+    // the state at the start of each slice (and at the end of the last one),
+    // the end state of each slice through the coarse and fine propagators,
+    // the private state of each slice, and the state of the coarse propagator
+    double* Us = vector(double, (size_t)(S + 1) * n + 1);
+    double* Gs = vector(double, (size_t)S * n + 1);
+    double* Fs = vector(double, (size_t)S * n + 1);
+    double* Ws = vector(double, (size_t)S * n + 1);
+    double* Vs = vector(double, (size_t)S * m + 1);
+    network_state cs = { vector(double, n + 1), vector(double, m) };
+
+    memcpy(Us, ns.Ys + cc.js_skip, n * sizeof(double));
+
+    // predict the start of the slices with the coarse propagator
+    int result = 0;
+    for (int s = 0; s < S && result == 0; s++)
+    {
+        memcpy(cs.Ys, Us + (size_t)s * n, n * sizeof(double));
+
+        result = propagate(cs, lcc, lit, l2s, inputs, NULL, it.sources_count, s * steps / S, (s + 1) * steps / S, ps.coarse_ratio, ps.coarse);
+
+        memcpy(Gs + (size_t)s * n, cs.Ys, n * sizeof(double));
+        memcpy(Us + (size_t)(s + 1) * n, cs.Ys, n * sizeof(double));
+    }
+
+    int iteration = 0;
+    double change = INFINITY;
+    while (iteration < ps.max_iterations && change > ps.tolerance && result == 0)
+    {
+        iteration++;
+
+        // refine all the slices concurrently with the exact stepping
+        #pragma omp parallel for reduction(min:result)
+        for (int s = 0; s < S; s++)
+        {
+            network_state ls = { Ws + (size_t)s * n, Vs + (size_t)s * m };
+            memcpy(ls.Ys, Us + (size_t)s * n, n * sizeof(double));
+
+            int r = propagate(ls, lcc, lit, l2s, inputs, ios, it.sources_count, s * steps / S, (s + 1) * steps / S, 1, settings);
+            result = r < result ? r : result;
+
+            memcpy(Fs + (size_t)s * n, ls.Ys, n * sizeof(double));
+        }
+
+        // correct the start of the slices sequentially: the coarse
+        // propagation of the new state plus the fine-coarse difference of
+        // the previous one
+        change = 0;
+        for (int s = 0; s < S && result == 0; s++)
+        {
+            memcpy(cs.Ys, Us + (size_t)s * n, n * sizeof(double));
+
+            result = propagate(cs, lcc, lit, l2s, inputs, NULL, it.sources_count, s * steps / S, (s + 1) * steps / S, ps.coarse_ratio, ps.coarse);
+
+            double* G = Gs + (size_t)s * n;
+            double* F = Fs + (size_t)s * n;
+            double* U = Us + (size_t)(s + 1) * n;
+            for (int k = 0; k < n; k++)
+            {
+                double Y = cs.Ys[k] + F[k] - G[k];
+                Y = Y < Y_MIN ? Y_MIN : Y > Y_MAX ? Y_MAX : Y;
+
+                double c = fabs(Y - U[k]) / (Y_MAX - Y_MIN);
+                change = c > change ? c : change;
+
+                G[k] = cs.Ys[k];
+                U[k] = Y;
+            }
+        }
+    }
+
+    // the final state is the fine propagation of the last slice
+    if (result == 0)
+    {
+        memcpy(ns.Ys + cc.js_skip, Fs + (size_t)(S - 1) * n, n * sizeof(double));
+        memcpy(ns.Vs + cc.ws_skip, Vs + (size_t)(S - 1) * m, m * sizeof(double));
+    }
+
+    free(inputs);
+    free(Us);
+    free(Gs);
+    free(Fs);
+    free(Ws);
+    free(Vs);
+    free(cs.Ys);
+    free(cs.Vs);
+
+    requires(result == 0, -1, "The Parareal stimulation failed!\n");
+
+    return iteration;
+}
+
+step_plan create_step_plan(
+    const connected_component ccs[],
+    int ccs_count,
+    const interface it
+)
+{
+    // sort the components by decreasing size, so that the largest solutions
+    // are started first
+    connected_component* sorted = vector(connected_component, ccs_count + 1);
+    memcpy(sorted, ccs, ccs_count * sizeof(connected_component));
+    qsort(sorted, ccs_count, sizeof(connected_component), cccmp);
+
+    step_plan sp = {
+        ccs_count,
+        vector(connected_component, ccs_count + 1),
+        vector(interface, ccs_count + 1),
+        vector(int, ccs_count + 1),
+        vector(int, it.sources_count + 1),
+        0,
+        NULL
+    };
+
+    int chunks_count = 0;
+    for (int c = 0; c < ccs_count; c++)
+    {
+        sp.ccs[c] = sorted[ccs_count - 1 - c];
+
+        sp.ss[c] = c ? sp.ss[c - 1] + sp.its[c - 1].sources_count : 0;
+        sp.its[c] = restrict_interface(it, sp.ccs[c], sp.s2i + sp.ss[c]);
+
+        if (sp.ccs[c].js_count > SPLIT_JUNCTIONS)
+        {
+            chunks_count += (sp.ccs[c].js_count + SPLIT_JUNCTIONS - 1) / SPLIT_JUNCTIONS;
+        }
+    }
+    sp.ss[ccs_count] = ccs_count ? sp.ss[ccs_count - 1] + sp.its[ccs_count - 1].sources_count : 0;
+    free(sorted);
+
+    // a chunk is a CC with a subset of the junctions: it can be updated as
+    // any other CC
+    sp.chunks = vector(connected_component, chunks_count + 1);
+    for (int c = 0; c < ccs_count; c++)
+    {
+        // the components are sorted by nanowires first: a component with
+        // many junctions can follow smaller ones
+        connected_component cc = sp.ccs[c];
+        if (cc.js_count <= SPLIT_JUNCTIONS)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < cc.js_count; k += SPLIT_JUNCTIONS)
+        {
+            sp.chunks[sp.chunks_count++] = (connected_component){
+                cc.ws_count,
+                k + SPLIT_JUNCTIONS < cc.js_count ? SPLIT_JUNCTIONS : cc.js_count - k,
+                cc.ws_skip,
+                cc.js_skip + k,
+                cc.Is + k
+            };
+        }
+    }
+
+    return sp;
+}
+
+int network_step(network_state ns, const step_plan sp, double io[])
+{
+    int failures = 0;
+
+    // the nested parallel loops of the update and of the stimulation of a
+    // component are executed by the thread that encounters them
+    #pragma omp parallel reduction(+:failures)
+    {
+        // the largest components are updated by all the threads, a chunk of
+        // junctions each
+        #pragma omp for schedule(dynamic)
+        for (int k = 0; k < sp.chunks_count; k++)
+        {
+            update_conductance(ns, sp.chunks[k]);
+        }
+
+        // then each thread updates and stimulates a component at a time
+        #pragma omp for schedule(dynamic)
+        for (int c = 0; c < sp.ccs_count; c++)
+        {
+            connected_component cc = sp.ccs[c];
+            interface lit = sp.its[c];
+            const int* s2i = sp.s2i + sp.ss[c];
+
+            if (cc.js_count <= SPLIT_JUNCTIONS)
+            {
+                update_conductance(ns, cc);
+            }
+
+            // without sources, the voltage of the component is null
+            if (lit.sources_count == 0)
+            {
+                memset(ns.Vs + cc.ws_skip, 0, cc.ws_count * sizeof(double));
+                continue;
+            }
+
+            double lio[lit.sources_count];
+            for (int i = 0; i < lit.sources_count; i++)
+            {
+                lio[i] = io[s2i[i]];
+            }
+
+            failures += voltage_stimulation(ns, cc, lit, lio) != 0;
+
+            for (int i = 0; i < lit.sources_count; i++)
+            {
+                io[s2i[i]] = lio[i];
+            }
+        }
+    }
+    requires(failures == 0, -1, "The MNA system of %d components cannot be solved!\n", failures);
+
+    return 0;
+}
+
+void destroy_step_plan(step_plan sp)
+{
+    for (int c = 0; c < sp.ccs_count; c++)
+    {
+        destroy_interface(sp.its[c]);
+    }
+
+    free(sp.ccs);
+    free(sp.its);
+    free(sp.ss);
+    free(sp.s2i);
+    free(sp.chunks);
+}
+
+static int propagate(
+    network_state ls,
+    const connected_component lcc,
+    const interface lit,
+    const int l2s[],
+    const double inputs[],
+    double ios[],
+    int sources_count,
+    int from,
+    int to,
+    int ratio,
+    const mna_settings settings
+)
+{
+    double lio[lit.sources_count + 1];
+    for (int t = from; t < to; t += ratio)
+    {
+        const double* input = inputs + (size_t)t * sources_count;
+        for (int i = 0; i < lit.sources_count; i++)
+        {
+            lio[i] = input[l2s[i]];
+        }
+
+        int result = voltage_stimulation_with(ls, lcc, lit, lio, settings);
+        requires(result == 0, -1, "The stimulation failed at step %d!\n", t);
+
+        if (ratio == 1)
+        {
+            update_conductance(ls, lcc);
+        }
+        else
+        {
+            int length = to - t < ratio ? to - t : ratio;
+            update_conductance_dt(ls, lcc, length * TAU);
+        }
+
+        // the sources not connected to the CC keep their voltage
+        if (ios != NULL)
+        {
+            double* io = ios + (size_t)t * sources_count;
+            for (int i = 0; i < lit.sources_count; i++)
+            {
+                io[l2s[i]] = lio[i];
+            }
+        }
+    }
+
+    return 0;
+}
+
+static bool mixing_coefficients(
+    const double dFs[],
+    const double f[],
+    int n,
+    int depth,
+    double γ[]
+)
+{
+    // build the normal equations M γ = r, with M = dFs' dFs and r = dFs' f
+    double M[depth][depth + 1];
+    for (int i = 0; i < depth; i++)
+    {
+        for (int j = i; j <= depth; j++)
+        {
+            const double* column = j < depth ? dFs + j * n : f;
+
+            double dot = 0;
+            for (int k = 0; k < n; k++)
+            {
+                dot += dFs[i * n + k] * column[k];
+            }
+            M[i][j] = dot;
+
+            if (j < depth)
+            {
+                M[j][i] = dot;
+            }
+        }
+    }
+
+    // solve the system by Gaussian elimination with partial pivoting
+    for (int c = 0; c < depth; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < depth; r++)
+        {
+            pivot = fabs(M[r][c]) > fabs(M[pivot][c]) ? r : pivot;
+        }
+
+        if (fabs(M[pivot][c]) < 1e-300)
+        {
+            return false;
+        }
+
+        for (int j = 0; j <= depth; j++)
+        {
+            double t = M[c][j];
+            M[c][j] = M[pivot][j];
+            M[pivot][j] = t;
+        }
+
+        for (int r = c + 1; r < depth; r++)
+        {
+            double factor = M[r][c] / M[c][c];
+            for (int j = c; j <= depth; j++)
+            {
+                M[r][j] -= factor * M[c][j];
+            }
+        }
+    }
+
+    for (int c = depth - 1; c >= 0; c--)
+    {
+        γ[c] = M[c][depth];
+        for (int j = c + 1; j < depth; j++)
+        {
+            γ[c] -= M[c][j] * γ[j];
+        }
+        γ[c] /= M[c][c];
+    }
+
+    return true;
+}
+
+static interface restrict_interface(
+    const interface it,
+    const connected_component cc,
+    int s2i[]
+)
+{
+    interface lit = {
+        0, vector(int, it.sources_count + 1),
+        0, vector(int, it.grounds_count + 1),
+        0, vector(int, it.loads_count + 1), vector(double, it.loads_count + 1)
+    };
+
+    for (int i = 0; i < it.sources_count; i++)
+    {
+        int nwi = it.sources_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            s2i[lit.sources_count] = i;
+            lit.sources_index[lit.sources_count++] = it.sources_index[i];
+        }
+    }
+
+    for (int i = 0; i < it.grounds_count; i++)
+    {
+        int nwi = it.grounds_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            lit.grounds_index[lit.grounds_count++] = it.grounds_index[i];
+        }
+    }
+
+    for (int i = 0; i < it.loads_count; i++)
+    {
+        int nwi = it.loads_index[i] - cc.ws_skip;
+        if (0 <= nwi && nwi < cc.ws_count)
+        {
+            lit.loads_weight[lit.loads_count] = it.loads_weight[i];
+            lit.loads_index[lit.loads_count++] = it.loads_index[i];
+        }
+    }
+
+    return lit;
+}
@@ -0,0 +1,208 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "config.h"
+#include "device/network.h"
+#include "io/serializer.h"
+#include "stimulator/stepping.h"
+#include "stimulator/sweep.h"
+#include "util/components.h"
+#include "util/errors.h"
+#include "util/tensors.h"
+
+// topology of a datasheet, shared by all its jobs
+typedef struct
+{
+    network_topology        nt;         // topology of the device
+    int                     ccs_count;  // number of connected components
+    connected_component*    ccs;        // connected components of the device
+} device;
+
+// estimated cost of a job, used to start the longest jobs first
+typedef struct
+{
+    int     job;    // index of the job
+    double  cost;   // number of nanowires times the number of steps
+} job_cost;
+
+// compare two jobs according to their decreasing cost
+static int jccmp(const void* e1, const void* e2);
+
+// generate the topology of a datasheet and split it in connected components
+static device generate_device(const datasheet ds);
+
+// execute a job of the sweep on the topology of its datasheet
+static int run_job(const sweep sw, const device dv, int d, int m, int p);
+
+int sweep_job(const sweep sw, int d, int m, int p)
+{
+    return (d * sw.meas_count + m) * sw.protocols_count + p;
+}
+
+int run_sweep(const sweep sw)
+{
+    // each protocol must stimulate the sources of each MEA configuration
+    for (int m = 0; m < sw.meas_count; m++)
+    {
+        int sources_count = 0;
+        for (int i = 0; i < MEA_ELECTRODES; i++)
+        {
+            sources_count += sw.meas[m].ct[i] == SOURCE;
+        }
+
+        for (int p = 0; p < sw.protocols_count; p++)
+        {
+            requires(sw.protocols[p].sources_count == sources_count, -1, "The protocol %d does not match the sources of the MEA %d!\n", p, m);
+        }
+    }
+
+    int jobs_count = sw.datasheets_count * sw.meas_count * sw.protocols_count;
+    device* dvs = vector(device, sw.datasheets_count + 1);
+    job_cost* jcs = vector(job_cost, jobs_count + 1);
+
+    for (int d = 0; d < sw.datasheets_count; d++)
+    {
+        for (int m = 0; m < sw.meas_count; m++)
+        {
+            for (int p = 0; p < sw.protocols_count; p++)
+            {
+                int job = sweep_job(sw, d, m, p);
+                jcs[job] = (job_cost){ job, (double)sw.dss[d].wires_count * sw.protocols[p].steps };
+            }
+        }
+    }
+    qsort(jcs, jobs_count, sizeof(job_cost), jccmp);
+
+    int threads_count = sw.threads_count;
+#ifdef _OPENMP
+    threads_count = threads_count > 0 ? threads_count : omp_get_num_procs();
+#endif
+
+    int failures = 0;
+
+    #pragma omp parallel num_threads(threads_count)
+    #pragma omp single
+    {
+        // generate each topology once, in parallel with the other ones
+        for (int d = 0; d < sw.datasheets_count; d++)
+        {
+            #pragma omp task depend(out: dvs[d]) firstprivate(d)
+            dvs[d] = generate_device(sw.dss[d]);
+        }
+
+        // a job can start as soon as the topology of its datasheet is ready
+        for (int j = 0; j < jobs_count; j++)
+        {
+            int job = jcs[j].job;
+            int p = job % sw.protocols_count;
+            int m = job / sw.protocols_count % sw.meas_count;
+            int d = job / sw.protocols_count / sw.meas_count;
+
+            #pragma omp task depend(in: dvs[d]) firstprivate(d, m, p) shared(failures)
+            {
+                int result = run_job(sw, dvs[d], d, m, p);
+
+                #pragma omp atomic
+                failures += result != 0;
+            }
+        }
+    }
+
+    for (int d = 0; d < sw.datasheets_count; d++)
+    {
+        for (int c = 0; c < dvs[d].ccs_count; c++)
+        {
+            destroy_component(dvs[d].ccs[c]);
+        }
+        free(dvs[d].ccs);
+        destroy_topology(dvs[d].nt);
+    }
+    free(dvs);
+    free(jcs);
+
+    requires(failures == 0, -1, "%d jobs of the sweep failed!\n", failures);
+
+    return 0;
+}
+
+static int jccmp(const void* e1, const void* e2)
+{
+    job_cost a = *((job_cost*)e1);
+    job_cost b = *((job_cost*)e2);
+
+    return (a.cost < b.cost) - (a.cost > b.cost);
+}
+
+static device generate_device(const datasheet ds)
+{
+    device dv;
+
+    int* n2c = vector(int, ds.wires_count);
+    dv.nt = create_network(ds, n2c, &dv.ccs_count);
+    dv.ccs = split_components(ds, dv.nt, n2c, dv.ccs_count);
+    free(n2c);
+
+    return dv;
+}
+
+static int run_job(const sweep sw, const device dv, int d, int m, int p)
+{
+    const datasheet ds = sw.dss[d];
+    const protocol pr = sw.protocols[p];
+    int id = sweep_job(sw, d, m, p);
+
+    // connect the MEA to the device, with the configured electrodes
+    MEA mea = connect_MEA(ds, dv.nt);
+    memcpy(mea.ct, sw.meas[m].ct, sizeof(mea.ct));
+    memcpy(mea.ws, sw.meas[m].ws, sizeof(mea.ws));
+
+    interface it = mea2interface(mea);
+    network_state ns = construe_circuit(ds, dv.nt);
+    step_plan sp = create_step_plan(dv.ccs, dv.ccs_count, it);
+
+    bool saved = serialize_network(ds, dv.nt, sw.path, id) == 0;
+    saved = saved && serialize_mea(mea, sw.path, id, 0) == 0;
+    saved = saved && serialize_interface(it, sw.path, id, 0) == 0;
+
+    // the currents drawn from the sources follow their number, a row per step
+    FILE* currents = saved ? create_file(CURRENTS_FILE_NAME_FORMAT, sw.path, id, -1) : NULL;
+    saved = currents != NULL && fwrite(&pr.sources_count, sizeof(int), 1, currents) == 1;
+
+    int result = saved ? 0 : -1;
+    for (int s = 0; s < pr.steps && result == 0; s++)
+    {
+        double io[pr.sources_count + 1];
+        memcpy(io, pr.inputs + (size_t)s * pr.sources_count, pr.sources_count * sizeof(double));
+
+        result = network_step(ns, sp, io);
+
+        if (result == 0 && fwrite(io, sizeof(double), pr.sources_count, currents) != (size_t)pr.sources_count)
+        {
+            result = -1;
+        }
+
+        // stream the state of the snapshots, and always the last one
+        if (result == 0 && (s == pr.steps - 1 || (sw.snapshot_period > 0 && s % sw.snapshot_period == 0)))
+        {
+            result = serialize_state(ds, dv.nt, ns, sw.path, id, s);
+        }
+    }
+
+    if (currents != NULL && fclose(currents) != 0)
+    {
+        result = -1;
+    }
+
+    destroy_step_plan(sp);
+    destroy_state(ns);
+    destroy_interface(it);
+
+    requires(result == 0, -1, "The job %d of the sweep failed!\n", id);
+
+    return 0;
+}
@@ -1,12 +1,38 @@
 #include <math.h>
+#include <stdlib.h>
 
 #include "stimulator/update.h"
 #include "config.h"
+#include "util/parallelism.h"
+#include "util/tensors.h"
+
+// calculate the absolute voltage drop on the k-th junction of a CC
+static double voltage_drop(
+    const network_state ns,
+    const connected_component cc,
+    int k
+);
+
+// compute the coefficients of the affine recurrence g' = a + b * g followed by
+// the normalized conductance of a junction with a fixed voltage drop
+static void coefficients(double ΔV, double* a, double* b);
+
+// advance the conductance of a junction by a (possibly fractional) number of
+// steps of the affine recurrence g' = a + b * g
+static double advance(double Y, double a, double b, double steps);
+
+// calculate the number of steps (a power of two) for which the normalized
+// conductance of a junction does not change more than the tolerance
+static int period(double Y, double a, double b, double tolerance, int max_period);
+
+// advance the conductance of the junctions of a CC by a (possibly fractional)
+// number of steps at fixed voltages
+static void relax(network_state ns, connected_component cc, double steps);
 
 void update_conductance(network_state ns, connected_component cc)
 {
     // iterate over all the junction indexes
-    #pragma omp parallel for
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
     for (int k = 0; k < cc.js_count; k++)
     {
         // get the index of the wires in the nanowire-network state
@@ -16,16 +42,305 @@ void update_conductance(network_state ns, connected_component cc)
         // calculate the delta voltage on each junction
         double ΔV = fabs(ns.Vs[i] - ns.Vs[j]);
 
-        // compute the potentiation and depression coefficients
-        double kp = KP * exp(ETA_P * ΔV);
-        double kd = KD * exp(-ETA_D * ΔV);
-        double kpd = kp + kd;
+        ns.Ys[cc.js_skip + k] = updated_conductance(ns.Ys[cc.js_skip + k], ΔV);
+    }
+}
+
+double updated_conductance(double Y, double ΔV)
+{
+    // compute the potentiation and depression coefficients
+    double kp = KP * exp(ETA_P * ΔV);
+    double kd = KD * exp(-ETA_D * ΔV);
+    double kpd = kp + kd;
+
+    // calculate the conductance of the junction
+    double g = (Y - Y_MIN) / (Y_MAX - Y_MIN);
+    g = kp / kpd * (1 + kd / kp * g * exp(-TAU * kpd));
+
+    // calculate the circuit admittance
+    return Y_MIN + g * (Y_MAX - Y_MIN);
+}
+
+void advance_conductance(network_state ns, connected_component cc, int steps)
+{
+    relax(ns, cc, steps);
+}
+
+void update_conductance_dt(network_state ns, connected_component cc, double dt)
+{
+    relax(ns, cc, dt / TAU);
+}
+
+double conductance_step(
+    const network_state ns,
+    const connected_component cc,
+    double tolerance
+)
+{
+    double dt = INFINITY;
 
-        // calculate the conductance of the junction
+    // iterate over all the junction indexes
+    #pragma omp parallel for reduction(min:dt) if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double a, b;
+        coefficients(voltage_drop(ns, cc, k), &a, &b);
+
+        // the distance of the conductance from its fixed point decays by a
+        // factor b at each step; find the steps shrinking it by tolerance
         double g = (ns.Ys[cc.js_skip + k] - Y_MIN) / (Y_MAX - Y_MIN);
-        g = kp / kpd * (1 + kd / kp * g * exp(-TAU * kpd));
+        double distance = fabs(g - a / (1 - b));
+
+        if (distance > tolerance)
+        {
+            double steps = log(1 - tolerance / distance) / log(b);
+            dt = steps * TAU < dt ? steps * TAU : dt;
+        }
+    }
+
+    return dt;
+}
+
+void equilibrium_conductance(
+    const network_state ns,
+    const connected_component cc,
+    double Ys[]
+)
+{
+    // iterate over all the junction indexes
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double a, b;
+        coefficients(voltage_drop(ns, cc, k), &a, &b);
+
+        Ys[k] = Y_MIN + a / (1 - b) * (Y_MAX - Y_MIN);
+    }
+}
+
+multirate_schedule create_schedule(
+    const connected_component cc,
+    double tolerance,
+    int max_period,
+    double voltage_tolerance
+)
+{
+    // all the junctions are updated at the first step
+    multirate_schedule ms = {
+        cc.js_count, 0, tolerance, max_period, voltage_tolerance,
+        vector(int, cc.js_count + 1),
+        zeros_vector(int, cc.js_count + 1),
+        zeros_vector(double, cc.js_count + 1),
+        0
+    };
+
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        ms.periods[k] = 1;
+    }
+
+    return ms;
+}
+
+void multirate_update(
+    network_state ns,
+    const connected_component cc,
+    multirate_schedule* ms
+)
+{
+    int step = ++ms->step;
+    long updates_count = 0;
+
+    // iterate over all the junction indexes
+    #pragma omp parallel for reduction(+:updates_count) if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double ΔV = voltage_drop(ns, cc, k);
+        int elapsed = step - ms->lasts[k];
+        int moved = fabs(ΔV - ms->drops[k]) > ms->voltage_tolerance;
+
+        // a junction waits for the end of its period, unless its voltage drop
+        // changed in the meantime
+        if (elapsed < ms->periods[k] && !moved)
+        {
+            continue;
+        }
+
+        double a, b;
+        double Y = ns.Ys[cc.js_skip + k];
+
+        // the skipped steps had the voltage drop of the last update
+        if (moved && elapsed > 1)
+        {
+            coefficients(ms->drops[k], &a, &b);
+            Y = advance(Y, a, b, elapsed - 1);
+            elapsed = 1;
+        }
+
+        coefficients(ΔV, &a, &b);
+        Y = advance(Y, a, b, elapsed);
+
+        // reclassify the junction according to its current rate
+        ns.Ys[cc.js_skip + k] = Y;
+        ms->lasts[k] = step;
+        ms->drops[k] = ΔV;
+        ms->periods[k] = period(Y, a, b, ms->tolerance, ms->max_period);
+
+        updates_count++;
+    }
+
+    ms->updates_count += updates_count;
+}
+
+void flush_schedule(
+    network_state ns,
+    const connected_component cc,
+    multirate_schedule* ms
+)
+{
+    // iterate over all the junction indexes
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        if (ms->lasts[k] < ms->step)
+        {
+            double a, b;
+            coefficients(ms->drops[k], &a, &b);
+
+            ns.Ys[cc.js_skip + k] = advance(ns.Ys[cc.js_skip + k], a, b, ms->step - ms->lasts[k]);
+            ms->lasts[k] = ms->step;
+        }
+    }
+}
+
+void destroy_schedule(multirate_schedule ms)
+{
+    free(ms.periods);
+    free(ms.lasts);
+    free(ms.drops);
+}
+
+update_cache create_update_cache(
+    const connected_component cc,
+    double voltage_tolerance
+)
+{
+    update_cache uc = {
+        cc.js_count, voltage_tolerance,
+        vector(double, cc.js_count + 1),
+        vector(double, cc.js_count + 1),
+        vector(double, cc.js_count + 1),
+        0
+    };
+
+    // an unknown voltage drop forces the computation at the first update
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        uc.drops[k] = NAN;
+    }
+
+    return uc;
+}
+
+void cached_update(
+    network_state ns,
+    const connected_component cc,
+    update_cache* uc
+)
+{
+    long refreshes_count = 0;
+
+    // iterate over all the junction indexes
+    #pragma omp parallel for reduction(+:refreshes_count) if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double ΔV = voltage_drop(ns, cc, k);
+
+        // recompute the coefficients only if the voltage drop moved
+        if (!(fabs(ΔV - uc->drops[k]) <= uc->voltage_tolerance))
+        {
+            coefficients(ΔV, &uc->as[k], &uc->bs[k]);
+            uc->drops[k] = ΔV;
+            refreshes_count++;
+        }
+
+        double g = (ns.Ys[cc.js_skip + k] - Y_MIN) / (Y_MAX - Y_MIN);
+        g = uc->as[k] + uc->bs[k] * g;
 
-        // calculate and set circuit admittance
         ns.Ys[cc.js_skip + k] = Y_MIN + g * (Y_MAX - Y_MIN);
     }
+
+    uc->refreshes_count += refreshes_count;
+}
+
+void destroy_update_cache(update_cache uc)
+{
+    free(uc.drops);
+    free(uc.as);
+    free(uc.bs);
+}
+
+static double voltage_drop(
+    const network_state ns,
+    const connected_component cc,
+    int k
+)
+{
+    // get the index of the wires in the nanowire-network state
+    int i = cc.ws_skip + cc.Is[k] / cc.ws_count;
+    int j = cc.ws_skip + cc.Is[k] % cc.ws_count;
+
+    return fabs(ns.Vs[i] - ns.Vs[j]);
+}
+
+static void coefficients(double ΔV, double* a, double* b)
+{
+    // compute the potentiation and depression coefficients
+    double kp = KP * exp(ETA_P * ΔV);
+    double kd = KD * exp(-ETA_D * ΔV);
+    double kpd = kp + kd;
+
+    *a = kp / kpd;
+    *b = kd / kpd * exp(-TAU * kpd);
+}
+
+static double advance(double Y, double a, double b, double steps)
+{
+    // calculate the fixed point of the recurrence, to which the conductance
+    // relaxes, and the conductance after the given steps
+    double g_inf = a / (1 - b);
+    double g = (Y - Y_MIN) / (Y_MAX - Y_MIN);
+    g = g_inf + pow(b, steps) * (g - g_inf);
+
+    // calculate the circuit admittance
+    return Y_MIN + g * (Y_MAX - Y_MIN);
+}
+
+static int period(double Y, double a, double b, double tolerance, int max_period)
+{
+    // the distance of the conductance from its fixed point decays by a factor
+    // b at each step; find the steps shrinking it by tolerance
+    double g = (Y - Y_MIN) / (Y_MAX - Y_MIN);
+    double distance = fabs(g - a / (1 - b));
+    double steps = distance > tolerance ? log(1 - tolerance / distance) / log(b) : max_period;
+
+    int p = 1;
+    while (2 * p <= max_period && 2 * p <= steps)
+    {
+        p *= 2;
+    }
+    return p;
+}
+
+static void relax(network_state ns, connected_component cc, double steps)
+{
+    // iterate over all the junction indexes
+    #pragma omp parallel for if(cc.js_count >= parallel_threshold(UPDATE_GRAIN))
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        double a, b;
+        coefficients(voltage_drop(ns, cc, k), &a, &b);
+
+        ns.Ys[cc.js_skip + k] = advance(ns.Ys[cc.js_skip + k], a, b, steps);
+    }
 }
@@ -194,3 +194,42 @@ connected_component* split_components(
 
     return ccs;
 }
+
+void construe_adjacency_lists(
+    const connected_component cc,
+    int Ap[],
+    int Aj[],
+    int Ak[]
+)
+{
+    // count the junctions of each nanowire
+    memset(Ap, 0, (cc.ws_count + 1) * sizeof(int));
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        Ap[cc.Is[k] / cc.ws_count + 1]++;
+        Ap[cc.Is[k] % cc.ws_count + 1]++;
+    }
+
+    // calculate the starting index of the neighbours of each nanowire
+    for (int i = 0; i < cc.ws_count; i++)
+    {
+        Ap[i + 1] += Ap[i];
+    }
+
+    // fill the neighbours lists in both directions
+    int me[cc.ws_count] = { };
+    for (int k = 0; k < cc.js_count; k++)
+    {
+        int i = cc.Is[k] / cc.ws_count;
+        int j = cc.Is[k] % cc.ws_count;
+
+        if (Ak != NULL)
+        {
+            Ak[Ap[i] + me[i]] = k;
+            Ak[Ap[j] + me[j]] = k;
+        }
+
+        Aj[Ap[i] + me[i]++] = j;
+        Aj[Ap[j] + me[j]++] = i;
+    }
+}
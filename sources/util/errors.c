@@ -0,0 +1,31 @@
+#include <stdarg.h>
+
+#include "util/errors.h"
+
+// buffer receiving the messages of the thread, if any
+static _Thread_local char* thread_buffer = NULL;
+
+void report_error(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if (thread_buffer != NULL)
+    {
+        vsnprintf(thread_buffer, ERROR_LENGTH, format, args);
+    }
+    else
+    {
+        vprintf(format, args);
+    }
+
+    va_end(args);
+}
+
+char* redirect_errors(char* buffer)
+{
+    char* previous = thread_buffer;
+    thread_buffer = buffer;
+
+    return previous;
+}
@@ -0,0 +1,319 @@
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "config.h"
+#include "util/parallelism.h"
+#include "util/point.h"
+#include "util/tensors.h"
+
+// units of work of each probe, and repetitions of each measure (the minimum
+// is kept, being the least perturbed by the system)
+#define PROBE_UNITS 4096
+#define PROBE_REPETITIONS 16
+
+// side of the adjacency matrix written by the probe
+#define PROBE_SIDE 64
+
+// default thresholds, used until the first calibration: they parallelize
+// kernels of a few thousand units
+static const int DEFAULT_THRESHOLDS[GRAINS_COUNT] = { 1024, 16384, 8192, 8192 };
+
+// last calibration, accessed only in the critical section
+static calibration current = { 1, 0, { 0 }, { 0 } };
+
+// calibrated costs and set thresholds (-1 if not set), read without locking
+// by the kernels: the costs are published before the calibration flag, so
+// that a thread observing the flag also observes the calibrated costs
+static _Atomic double fork_join_cost = 0;
+static _Atomic double unit_costs[GRAINS_COUNT];
+static atomic_int set_thresholds[GRAINS_COUNT] = { -1, -1, -1, -1 };
+static atomic_bool calibrated = false;
+
+// sink of the results of the probes, preventing their removal
+static volatile double sink;
+
+// perform the calibration of all the kernels, or of the ones whose threshold
+// is not set
+static void calibrate(bool all);
+
+// return the number of threads of a parallel region opened by the caller
+static int team_size(void);
+
+// return the threshold of a kernel for a team of threads, given its costs
+static int team_threshold(double fork_join, double unit, int threads_count);
+
+// measure the cost of an empty parallel region with the given threads
+static double fork_join_time(int threads_count);
+
+// measure the serial cost of a unit of work of a kernel
+static double unit_time(grain_t grain);
+
+// return the current time in seconds
+static double now(void);
+
+calibration calibrate_thresholds(void)
+{
+    calibration result;
+
+    #pragma omp critical (nns_calibration)
+    {
+        calibrate(true);
+        result = current;
+    }
+
+    // the thresholds depend on the team of the caller
+    for (int g = 0; g < GRAINS_COUNT; g++)
+    {
+        result.thresholds[g] = parallel_threshold(g);
+    }
+
+    return result;
+}
+
+calibration current_calibration(void)
+{
+    calibration result;
+
+    // the calibration is triggered by the query of any threshold
+    parallel_threshold(UPDATE_GRAIN);
+
+    #pragma omp critical (nns_calibration)
+    {
+        result = current;
+    }
+
+    for (int g = 0; g < GRAINS_COUNT; g++)
+    {
+        result.thresholds[g] = parallel_threshold(g);
+    }
+
+    return result;
+}
+
+int parallel_threshold(grain_t grain)
+{
+    int threshold = atomic_load_explicit(&set_thresholds[grain], memory_order_relaxed);
+    if (threshold >= 0)
+    {
+        return threshold;
+    }
+
+    // a single thread never gains from a parallel region
+    int threads_count = team_size();
+    if (threads_count < 2)
+    {
+        return INT_MAX;
+    }
+
+    bool done = atomic_load_explicit(&calibrated, memory_order_acquire);
+#ifdef _OPENMP
+    // the probe must run outside any parallel region to measure a team
+    if (!done && !omp_in_parallel())
+#else
+    if (!done)
+#endif
+    {
+        #pragma omp critical (nns_calibration)
+        {
+            if (!atomic_load_explicit(&calibrated, memory_order_relaxed))
+            {
+                calibrate(false);
+            }
+        }
+        done = true;
+    }
+
+    if (!done)
+    {
+        return DEFAULT_THRESHOLDS[grain];
+    }
+
+    return team_threshold(
+        atomic_load_explicit(&fork_join_cost, memory_order_relaxed),
+        atomic_load_explicit(&unit_costs[grain], memory_order_relaxed),
+        threads_count
+    );
+}
+
+void set_parallel_threshold(grain_t grain, int threshold)
+{
+    #pragma omp critical (nns_calibration)
+    {
+        current.unit_times[grain] = 0;
+        atomic_store_explicit(&set_thresholds[grain], threshold < 0 ? 0 : threshold, memory_order_relaxed);
+    }
+}
+
+static void calibrate(bool all)
+{
+    // the probe measures a team of the caller, so that it never exceeds the
+    // threads the caller is allowed to use (e.g., the budget of a session)
+    current.threads_count = team_size();
+    current.fork_join_time = fork_join_time(current.threads_count);
+
+    for (int g = 0; g < GRAINS_COUNT; g++)
+    {
+        if (all)
+        {
+            atomic_store_explicit(&set_thresholds[g], -1, memory_order_relaxed);
+        }
+        if (atomic_load_explicit(&set_thresholds[g], memory_order_relaxed) >= 0)
+        {
+            continue;
+        }
+
+        current.unit_times[g] = unit_time(g);
+        current.thresholds[g] = team_threshold(current.fork_join_time, current.unit_times[g], current.threads_count);
+        atomic_store_explicit(&unit_costs[g], current.unit_times[g], memory_order_relaxed);
+    }
+
+    // publish the costs only once all of them are measured
+    atomic_store_explicit(&fork_join_cost, current.fork_join_time, memory_order_relaxed);
+    atomic_store_explicit(&calibrated, true, memory_order_release);
+}
+
+static int team_size(void)
+{
+#ifdef _OPENMP
+    // a region nested beyond the active levels is executed by a single thread
+    if (omp_get_active_level() >= omp_get_max_active_levels())
+    {
+        return 1;
+    }
+
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static int team_threshold(double fork_join, double unit, int threads_count)
+{
+    // the parallel execution is convenient when the work saved by the other
+    // threads exceeds the cost of the parallel region
+    double units = fork_join / (unit * (1 - 1.0 / threads_count));
+
+    return threads_count < 2 || !(units < INT_MAX) ? INT_MAX : (int)ceil(units);
+}
+
+static double fork_join_time(int threads_count)
+{
+    double best = INFINITY;
+    int xs[threads_count];
+
+    for (int r = 0; r < PROBE_REPETITIONS; r++)
+    {
+        double start = now();
+
+        #pragma omp parallel for num_threads(threads_count)
+        for (int i = 0; i < threads_count; i++)
+        {
+            xs[i] = i;
+        }
+
+        double elapsed = now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    sink = xs[threads_count - 1];
+
+    return best;
+}
+
+static double unit_time(grain_t grain)
+{
+    double* Vs = vector(double, PROBE_UNITS + 1);
+    double* Ys = vector(double, PROBE_UNITS);
+    point* Ps = vector(point, PROBE_UNITS);
+    bool* adj = zeros_vector(bool, PROBE_SIDE * PROBE_SIDE);
+
+    for (int k = 0; k <= PROBE_UNITS; k++)
+    {
+        Vs[k] = (k % 13) * 0.1;
+    }
+    for (int k = 0; k < PROBE_UNITS; k++)
+    {
+        Ys[k] = Y_MIN;
+        Ps[k] = (point){ k % 97, k % 89 };
+    }
+
+    double best = INFINITY;
+    for (int r = 0; r < PROBE_REPETITIONS; r++)
+    {
+        double start = now();
+
+        switch (grain)
+        {
+        case UPDATE_GRAIN:
+            // the body of update_conductance, between consecutive nanowires
+            for (int k = 0; k < PROBE_UNITS; k++)
+            {
+                double ΔV = fabs(Vs[k] - Vs[k + 1]);
+                double kp = KP * exp(ETA_P * ΔV);
+                double kd = KD * exp(-ETA_D * ΔV);
+                double kpd = kp + kd;
+                double g = (Ys[k] - Y_MIN) / (Y_MAX - Y_MIN);
+                g = kp / kpd * (1 + kd / kp * g * exp(-TAU * kpd));
+                Ys[k] = Y_MIN + g * (Y_MAX - Y_MIN);
+            }
+            break;
+        case CIRCUIT_GRAIN:
+            // the body of construe_circuit
+            for (int k = 0; k < PROBE_UNITS; k++)
+            {
+                Ys[k] = Y_MIN;
+            }
+            break;
+        case MEA_GRAIN:
+        {
+            // the inner body of connect_MEA, for a single electrode
+            double min_distance = INFINITY;
+            for (int k = 0; k < PROBE_UNITS; k++)
+            {
+                double distance = squared_distance((point){ 50, 50 }, Ps[k]);
+                if (distance < min_distance && distance < MAX_DISTANCE)
+                {
+                    min_distance = distance;
+                    Ys[0] = k;
+                }
+            }
+            break;
+        }
+        default:
+            // the body of construe_adjacency_matrix, on scattered junctions
+            for (int k = 0; k < PROBE_UNITS; k++)
+            {
+                int i = k * 31 % PROBE_SIDE, j = k * 17 % PROBE_SIDE;
+                adj[i * PROBE_SIDE + j] = true;
+                adj[j * PROBE_SIDE + i] = true;
+            }
+            break;
+        }
+
+        double elapsed = now() - start;
+        best = elapsed < best ? elapsed : best;
+        sink = Ys[r] + adj[r];
+    }
+
+    free(Vs);
+    free(Ys);
+    free(Ps);
+    free(adj);
+
+    // a unit too fast to be measured is bounded by the timer resolution
+    return fmax(best, 1e-9) / PROBE_UNITS;
+}
+
+static double now(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return 0;
+#endif
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include "util/distributions.h"
+#include "util/parallelism.h"
 #include "util/tensors.h"
 #include "util/wires.h"
 
@@ -145,7 +146,7 @@ bool** construe_adjacency_matrix(const datasheet ds, const network_topology nt)
     bool** adj = zeros_matrix(bool, ds.wires_count, ds.wires_count);
 
     // set an "adjacency" in presence of each junction
-    #pragma omp parallel for
+    #pragma omp parallel for if(nt.js_count >= parallel_threshold(ADJACENCY_GRAIN))
     for (int i = 0; i < nt.js_count; i++)
     {
         adj[nt.Js[i].first_wire][nt.Js[i].second_wire] = true;
@@ -0,0 +1,170 @@
+#include <math.h>
+
+#include "io/checkpoint.h"
+#include "io/deserializer.h"
+#include "util/errors.h"
+#include "tests.h"
+
+// number of states recorded in the tests
+#define STEPS 20
+
+/**
+ * Testing that the states recorded by the asynchronous writer, with fewer
+ * buffers than states, are the ones given at each step, even if the state is
+ * modified right after its checkpoint.
+ */
+void test_checkpoint_state()
+{
+    const datasheet ds = {
+        500,
+        40.0,
+        40.0 * 0.35,
+        100,
+        1234
+    };
+    int n2c[500], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+    const network_state ns = construe_circuit(ds, nt);
+
+    checkpoint_writer cw;
+    assert(create_checkpoint_writer(ds, nt, ".", 1, 2, &cw) == 0, -1, "The checkpoint writer cannot be created!\n");
+
+    for (int s = 0; s < STEPS; s++)
+    {
+        for (int i = 0; i < nt.js_count; i++)
+        {
+            ns.Ys[i] = s + i;
+        }
+        for (int i = 0; i < ds.wires_count; i++)
+        {
+            ns.Vs[i] = s - i;
+        }
+
+        checkpoint_state(&cw, ns, s);
+    }
+    assert(flush_checkpoints(&cw) == 0, -1, "The states have not been written!\n");
+    assert(cw.count == 0, -1, INT_ERROR, "cw.count", 0, cw.count);
+
+    for (int s = 0; s < STEPS; s++)
+    {
+        network_state loaded_ns;
+        deserialize_state(ds, nt, &loaded_ns, ".", 1, s);
+
+        for (int i = 0; i < nt.js_count; i++)
+        {
+            assert(loaded_ns.Ys[i] == s + i, -1, DOUBLE_ERROR, "loaded_ns.Ys[i]", (double)(s + i), loaded_ns.Ys[i]);
+        }
+        for (int i = 0; i < ds.wires_count; i++)
+        {
+            assert(loaded_ns.Vs[i] == s - i, -1, DOUBLE_ERROR, "loaded_ns.Vs[i]", (double)(s - i), loaded_ns.Vs[i]);
+        }
+
+        destroy_state(loaded_ns);
+    }
+
+    assert(destroy_checkpoint_writer(&cw) == 0, -1, "The writer has not written all the states!\n");
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the states recorded concurrently by different threads on the
+ * same writer are all written.
+ */
+void test_concurrent_checkpoints()
+{
+    const datasheet ds = {
+        200,
+        40.0,
+        40.0 * 0.35,
+        80,
+        1234
+    };
+    int n2c[200], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+
+    checkpoint_writer cw;
+    assert(create_checkpoint_writer(ds, nt, ".", 2, 2, &cw) == 0, -1, "The checkpoint writer cannot be created!\n");
+
+    #pragma omp parallel for num_threads(4)
+    for (int s = 0; s < STEPS; s++)
+    {
+        network_state ns = construe_circuit(ds, nt);
+        for (int i = 0; i < nt.js_count; i++)
+        {
+            ns.Ys[i] = s + i;
+        }
+        for (int i = 0; i < ds.wires_count; i++)
+        {
+            ns.Vs[i] = s - i;
+        }
+
+        checkpoint_state(&cw, ns, s);
+        destroy_state(ns);
+    }
+    assert(destroy_checkpoint_writer(&cw) == 0, -1, "The writer has not written all the states!\n");
+
+    for (int s = 0; s < STEPS; s++)
+    {
+        network_state loaded_ns;
+        deserialize_state(ds, nt, &loaded_ns, ".", 2, s);
+
+        for (int i = 0; i < nt.js_count; i++)
+        {
+            assert(loaded_ns.Ys[i] == s + i, -1, DOUBLE_ERROR, "loaded_ns.Ys[i]", (double)(s + i), loaded_ns.Ys[i]);
+        }
+        for (int i = 0; i < ds.wires_count; i++)
+        {
+            assert(loaded_ns.Vs[i] == s - i, -1, DOUBLE_ERROR, "loaded_ns.Vs[i]", (double)(s - i), loaded_ns.Vs[i]);
+        }
+
+        destroy_state(loaded_ns);
+    }
+
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the states that cannot be written are reported by the flush,
+ * without stopping the writer.
+ */
+void test_checkpoint_failure()
+{
+    const datasheet ds = {
+        200,
+        40.0,
+        40.0 * 0.35,
+        80,
+        1234
+    };
+    int n2c[200], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+    const network_state ns = construe_circuit(ds, nt);
+
+    // the base path does not exist: the folder of the device cannot be created
+    checkpoint_writer cw;
+    assert(create_checkpoint_writer(ds, nt, "./missing_folder", 3, 2, &cw) == 0, -1, "The checkpoint writer cannot be created!\n");
+
+    for (int s = 0; s < 3; s++)
+    {
+        checkpoint_state(&cw, ns, s);
+    }
+    assert(flush_checkpoints(&cw) == -1, -1, "The states not written have not been reported!\n");
+
+    // the failures are reported once, and the writer still accepts states
+    assert(flush_checkpoints(&cw) == 0, -1, "The failures have been reported twice!\n");
+    checkpoint_state(&cw, ns, 3);
+    assert(destroy_checkpoint_writer(&cw) == -1, -1, "The state not written has not been reported!\n");
+
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+int io_checkpoint()
+{
+    test_checkpoint_state();
+    test_concurrent_checkpoints();
+    test_checkpoint_failure();
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "io/codec.h"
+#include "util/errors.h"
+#include "tests.h"
+
+// number of values encoded in the tests
+#define VALUES 1000
+
+/**
+ * Testing that the values encoded as keyframes and as deltas, including the
+ * special ones, are decoded bitwise equal.
+ */
+void test_lossless_codec()
+{
+    double previous[VALUES], xs[VALUES], decoded[VALUES];
+    unsigned char encoding[encoded_bound(VALUES)];
+
+    for (int i = 0; i < VALUES; i++)
+    {
+        previous[i] = sin(i) * 1e-3;
+
+        // unchanged values, slightly changed ones and the special ones
+        xs[i] = i % 3 == 0 ? previous[i] : nextafter(previous[i], 1.0);
+    }
+    xs[1] = -0.0;
+    xs[2] = INFINITY;
+    xs[4] = NAN;
+    xs[VALUES - 1] = 0.0;
+
+    size_t size = encode_delta(xs, NULL, VALUES, encoding);
+    assert(size <= encoded_bound(VALUES), -1, INT_ERROR, "size", (int)encoded_bound(VALUES), (int)size);
+    assert(decode_delta(encoding, size, NULL, VALUES, decoded) == 0, -1, "The keyframe cannot be decoded!\n");
+    assert(memcmp(decoded, xs, sizeof(xs)) == 0, -1, "The keyframe is not decoded losslessly!\n");
+
+    size = encode_delta(xs, previous, VALUES, encoding);
+    assert(decode_delta(encoding, size, previous, VALUES, decoded) == 0, -1, "The delta cannot be decoded!\n");
+    assert(memcmp(decoded, xs, sizeof(xs)) == 0, -1, "The delta is not decoded losslessly!\n");
+
+    // the previous values can be decoded in place
+    assert(decode_delta(encoding, size, previous, VALUES, previous) == 0, -1, "The delta cannot be decoded!\n");
+    assert(memcmp(previous, xs, sizeof(xs)) == 0, -1, "The delta is not decoded losslessly in place!\n");
+
+    // a truncated encoding is rejected
+    assert(decode_delta(encoding, size - 1, NULL, VALUES, decoded) == -1, -1, "A truncated encoding has been decoded!\n");
+}
+
+/**
+ * Testing that the unchanged and slightly changed values are encoded in few
+ * bytes.
+ */
+void test_codec_compression()
+{
+    double previous[VALUES], xs[VALUES];
+    unsigned char encoding[encoded_bound(VALUES)];
+
+    for (int i = 0; i < VALUES; i++)
+    {
+        previous[i] = 1.0 + i;
+        xs[i] = previous[i];
+    }
+
+    // unchanged values are encoded by runs, whose repeated tokens take less
+    // than a byte each, plus the flush of the coder
+    size_t size = encode_delta(xs, previous, VALUES, encoding);
+    assert(size <= 12, -1, INT_ERROR, "size", 12, (int)size);
+
+    // a change of the last bit takes a token and a byte, at most
+    xs[500] = nextafter(xs[500], INFINITY);
+    size_t changed = encode_delta(xs, previous, VALUES, encoding);
+    assert(changed <= size + 2, -1, INT_ERROR, "changed", (int)size + 2, (int)changed);
+
+    // the same change on every value is encoded in less than a byte each:
+    // the tokens and the changed bytes repeat
+    for (int i = 0; i < VALUES; i++)
+    {
+        xs[i] = nextafter(previous[i], INFINITY);
+    }
+    size = encode_delta(xs, previous, VALUES, encoding);
+    assert(size < VALUES / 4, -1, INT_ERROR, "size", VALUES / 4, (int)size);
+
+    // the values of a keyframe equal to the preceding ones are encoded by
+    // runs
+    for (int i = 0; i < VALUES; i++)
+    {
+        xs[i] = i < VALUES / 2 ? 0.001 : 0.1;
+    }
+    size = encode_delta(xs, NULL, VALUES, encoding);
+    assert(size <= 32, -1, INT_ERROR, "size", 32, (int)size);
+
+    // the bytes of the noise are not reduced, while the bytes of the changes
+    // are
+    uint64_t bits = 0x9e3779b97f4a7c15;
+    for (int i = 0; i < VALUES; i++)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+
+        // a change of the 3 low bytes of the mantissa
+        uint64_t x;
+        memcpy(&x, previous + i, sizeof(double));
+        x ^= bits & 0xffffff;
+        memcpy(xs + i, &x, sizeof(double));
+    }
+    size = encode_delta(xs, previous, VALUES, encoding);
+    assert(size < 3 * VALUES + VALUES / 4, -1, INT_ERROR, "size", 3 * VALUES + VALUES / 4, (int)size);
+}
+
+/**
+ * Testing that the values that cannot be reduced are stored raw, and are not
+ * larger than the raw values.
+ */
+void test_raw_fallback()
+{
+    double xs[VALUES], decoded[VALUES];
+    unsigned char encoding[encoded_bound(VALUES)];
+
+    // values with all their bytes changing from one to the next
+    uint64_t bits = 0x9e3779b97f4a7c15;
+    for (int i = 0; i < VALUES; i++)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        memcpy(xs + i, &bits, sizeof(double));
+    }
+
+    size_t size = encode_delta(xs, NULL, VALUES, encoding);
+    assert(size == sizeof(xs), -1, INT_ERROR, "size", (int)sizeof(xs), (int)size);
+    assert(decode_delta(encoding, size, NULL, VALUES, decoded) == 0, -1, "The raw values cannot be decoded!\n");
+    assert(memcmp(decoded, xs, sizeof(xs)) == 0, -1, "The raw values are not decoded losslessly!\n");
+}
+
+int io_codec()
+{
+    test_lossless_codec();
+    test_codec_compression();
+    test_raw_fallback();
+
+    return 0;
+}
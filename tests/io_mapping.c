@@ -0,0 +1,86 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "io/mapping.h"
+#include "util/errors.h"
+#include "tests.h"
+
+/**
+ * Testing that a mapped network contains the serialized datasheet and
+ * topology, with its sections aligned.
+ */
+void test_network_mapping()
+{
+    const datasheet ds = {
+        2000,
+        40.0,
+        40.0 * 0.35,
+        200,
+        1234
+    };
+    int n2c[2000], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+
+    serialize_mapped_network(ds, nt, ".", 5);
+
+    mapped_network mn;
+    assert(map_network(".", 5, &mn) == 0, -1, "The network cannot be mapped!\n");
+
+    assert(dscmp(&mn.ds, &ds) == 0, -1, "The datasheet is not mapped correctly!\n");
+    assert(mn.ds.length_mean == ds.length_mean, -1, DOUBLE_ERROR, "mn.ds.length_mean", ds.length_mean, mn.ds.length_mean);
+    assert(mn.ds.length_std_dev == ds.length_std_dev, -1, DOUBLE_ERROR, "mn.ds.length_std_dev", ds.length_std_dev, mn.ds.length_std_dev);
+    assert(mn.nt.js_count == nt.js_count, -1, INT_ERROR, "mn.nt.js_count", nt.js_count, mn.nt.js_count);
+
+    // the topology points into the mapping, at aligned sections
+    assert((uintptr_t)mn.nt.Ws % 64 == 0, -1, "The nanowires section is not aligned!\n");
+    assert((uintptr_t)mn.nt.Js % 64 == 0, -1, "The junctions section is not aligned!\n");
+    assert((char*)mn.nt.Js + nt.js_count * sizeof(junction) <= (char*)mn.address + mn.size, -1, "The junctions exceed the mapping!\n");
+
+    assert(memcmp(mn.nt.Ws, nt.Ws, ds.wires_count * sizeof(wire)) == 0, -1, "The nanowires are not mapped correctly!\n");
+    assert(memcmp(mn.nt.Js, nt.Js, nt.js_count * sizeof(junction)) == 0, -1, "The junctions are not mapped correctly!\n");
+
+    unmap_network(mn);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that missing files and files of another version are not mapped.
+ */
+void test_invalid_mapping()
+{
+    const datasheet ds = {
+        500,
+        40.0,
+        40.0 * 0.35,
+        100,
+        1234
+    };
+    int n2c[500], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+
+    mapped_network mn;
+    assert(map_network(".", 999, &mn) == -1, -1, "A missing network has been mapped!\n");
+
+    // alter the version of the file
+    serialize_mapped_network(ds, nt, ".", 6);
+    char name[100];
+    snprintf(name, 100, MAPPED_NETWORK_FILE_NAME_FORMAT, ".", 6);
+    FILE* file = fopen(name, "r+b");
+    int version = -1;
+    fwrite(&version, sizeof(int), 1, file);
+    fclose(file);
+
+    assert(map_network(".", 6, &mn) == -1, -1, "A network of another version has been mapped!\n");
+
+    destroy_topology(nt);
+}
+
+int io_mapping()
+{
+    test_network_mapping();
+    test_invalid_mapping();
+
+    return 0;
+}
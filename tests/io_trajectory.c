@@ -0,0 +1,382 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "io/trajectory.h"
+#include "stimulator/mna.h"
+#include "stimulator/update.h"
+#include "util/components.h"
+#include "util/errors.h"
+#include "tests.h"
+
+// number of states appended in the tests
+#define STEPS 50
+
+/**
+ * Fill a network state with values depending on the step.
+ */
+static void fill_state(network_state ns, int js_count, int wires_count, int step)
+{
+    for (int i = 0; i < js_count; i++)
+    {
+        ns.Ys[i] = step + i;
+    }
+    for (int i = 0; i < wires_count; i++)
+    {
+        ns.Vs[i] = step - i;
+    }
+}
+
+/**
+ * Check that the state of a step read from a trajectory contains the values
+ * of that step.
+ */
+static void check_state(const trajectory tr, int step)
+{
+    network_state ns;
+    assert(read_state(tr, step, &ns) == 0, -1, "The state of step %d cannot be read!\n", step);
+
+    for (int i = 0; i < tr.js_count; i++)
+    {
+        assert(ns.Ys[i] == step + i, -1, DOUBLE_ERROR, "ns.Ys[i]", (double)(step + i), ns.Ys[i]);
+    }
+    for (int i = 0; i < tr.wires_count; i++)
+    {
+        assert(ns.Vs[i] == step - i, -1, DOUBLE_ERROR, "ns.Vs[i]", (double)(step - i), ns.Vs[i]);
+    }
+
+    destroy_state(ns);
+}
+
+/**
+ * Testing that the states appended to a trajectory, also after reopening it,
+ * are read by step in any order.
+ */
+void test_trajectory_io()
+{
+    const datasheet ds = {
+        500,
+        40.0,
+        40.0 * 0.35,
+        100,
+        1234
+    };
+    int n2c[500], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+    const network_state ns = construe_circuit(ds, nt);
+
+    trajectory tr;
+    assert(create_trajectory(ds, nt, ".", 2, &tr) == 0, -1, "The trajectory cannot be created!\n");
+    for (int s = 0; s < STEPS; s++)
+    {
+        fill_state(ns, nt.js_count, ds.wires_count, 10 * s);
+        assert(append_state(&tr, ns, 10 * s) == 0, -1, "The state cannot be appended!\n");
+    }
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    // append to the closed trajectory
+    assert(open_trajectory(ds, nt, ".", 2, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+    assert(tr.records_count == STEPS, -1, INT_ERROR, "tr.records_count", STEPS, tr.records_count);
+    for (int s = STEPS; s < 2 * STEPS; s++)
+    {
+        fill_state(ns, nt.js_count, ds.wires_count, 10 * s);
+        append_state(&tr, ns, 10 * s);
+    }
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    assert(open_trajectory(ds, nt, ".", 2, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+    assert(tr.records_count == 2 * STEPS, -1, INT_ERROR, "tr.records_count", 2 * STEPS, tr.records_count);
+    for (int s = 2 * STEPS - 1; s >= 0; s -= 7)
+    {
+        check_state(tr, 10 * s);
+    }
+
+    network_state missing;
+    assert(read_state(tr, 5, &missing) == -1, -1, "A missing step has been read!\n");
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the states of a trajectory not closed (e.g., after a crash)
+ * are recovered by scanning its records.
+ */
+void test_trajectory_recovery()
+{
+    const datasheet ds = {
+        500,
+        40.0,
+        40.0 * 0.35,
+        100,
+        1234
+    };
+    int n2c[500], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+    const network_state ns = construe_circuit(ds, nt);
+
+    trajectory tr;
+    create_trajectory(ds, nt, ".", 3, &tr);
+    for (int s = 0; s < STEPS; s++)
+    {
+        // the steps are not sorted
+        fill_state(ns, nt.js_count, ds.wires_count, (s * 7) % STEPS);
+        append_state(&tr, ns, (s * 7) % STEPS);
+    }
+
+    // interrupt the trajectory without writing the footer
+    fclose(tr.file);
+    free(tr.steps);
+    free(tr.offsets);
+
+    assert(open_trajectory(ds, nt, ".", 3, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+    assert(tr.records_count == STEPS, -1, INT_ERROR, "tr.records_count", STEPS, tr.records_count);
+    for (int s = 0; s < STEPS; s++)
+    {
+        check_state(tr, s);
+    }
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the states of a simulation appended to an encoded trajectory,
+ * also after reopening it or interrupting it, are read bitwise equal and
+ * take less space than the raw ones.
+ */
+void test_encoded_trajectory()
+{
+    const datasheet ds = {
+        500,
+        40.0,
+        40.0 * 0.35,
+        100,
+        1234
+    };
+    int n2c[500], cc_count;
+    const network_topology nt = create_network(ds, n2c, &cc_count);
+    const network_state ns = construe_circuit(ds, nt);
+    int count = nt.js_count + ds.wires_count;
+
+    // the expected states: few junctions change at each step
+    double (*xs)[count] = malloc(2 * STEPS * sizeof(double[count]));
+    for (int s = 0; s < 2 * STEPS; s++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            xs[s][i] = s == 0 || i % 10 == s % 10 ? sin(s + i) : xs[s - 1][i];
+        }
+    }
+
+    trajectory tr;
+    assert(create_encoded_trajectory(ds, nt, ".", 4, 8, &tr) == 0, -1, "The trajectory cannot be created!\n");
+    for (int s = 0; s < STEPS; s++)
+    {
+        memcpy(ns.Ys, xs[s], nt.js_count * sizeof(double));
+        memcpy(ns.Vs, xs[s] + nt.js_count, ds.wires_count * sizeof(double));
+        assert(append_state(&tr, ns, s) == 0, -1, "The state cannot be appended!\n");
+    }
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    // append to the closed trajectory, and interrupt it
+    assert(open_trajectory(ds, nt, ".", 4, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+    assert(tr.keyframe_period == 8, -1, INT_ERROR, "tr.keyframe_period", 8, tr.keyframe_period);
+    for (int s = STEPS; s < 2 * STEPS; s++)
+    {
+        memcpy(ns.Ys, xs[s], nt.js_count * sizeof(double));
+        memcpy(ns.Vs, xs[s] + nt.js_count, ds.wires_count * sizeof(double));
+        append_state(&tr, ns, s);
+    }
+    long long size = tr.end;
+    fclose(tr.file);
+    free(tr.steps);
+    free(tr.offsets);
+    free(tr.previous);
+    free(tr.current);
+    free(tr.buffer);
+
+    long long raw_size = 4 * sizeof(int) + 2 * STEPS * (2 * sizeof(int) + count * sizeof(double));
+    assert(2 * size < raw_size, -1, INT_ERROR, "size", (int)raw_size / 2, (int)size);
+
+    assert(open_trajectory(ds, nt, ".", 4, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+    assert(tr.records_count == 2 * STEPS, -1, INT_ERROR, "tr.records_count", 2 * STEPS, tr.records_count);
+    for (int s = 2 * STEPS - 1; s >= 0; s -= 3)
+    {
+        network_state read;
+        assert(read_state(tr, s, &read) == 0, -1, "The state of step %d cannot be read!\n", s);
+
+        bool equal = memcmp(read.Ys, xs[s], nt.js_count * sizeof(double)) == 0;
+        equal = equal && memcmp(read.Vs, xs[s] + nt.js_count, ds.wires_count * sizeof(double)) == 0;
+        assert(equal, -1, "The state of step %d is not decoded losslessly!\n", s);
+
+        destroy_state(read);
+    }
+    assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+    free(xs);
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the trajectory of a simulation, with the largest component
+ * stimulated and then left to relax, is reduced by the encoding, and that its
+ * keyframes are not larger than the raw states.
+ */
+void test_simulated_trajectory()
+{
+    const datasheet ds = {
+        100,
+        40.0,
+        14.0,
+        50,
+        1234
+    };
+    int n2c[100], ccs_count;
+    const network_topology nt = create_network(ds, n2c, &ccs_count);
+    const network_state ns = construe_circuit(ds, nt);
+    connected_component* ccs = split_components(ds, nt, n2c, ccs_count);
+
+    connected_component lcc = ccs[0];
+    for (int i = 0; i < ccs_count; i++)
+    {
+        lcc = ccs[i].ws_count > lcc.ws_count ? ccs[i] : lcc;
+    }
+    int sources[1] = { lcc.ws_skip };
+    int grounds[1] = { lcc.ws_skip + lcc.ws_count - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    // the same states as raw records, as keyframes only and as deltas
+    trajectory raw_tr, keyframes_tr, encoded_tr;
+    create_trajectory(ds, nt, ".", 7, &raw_tr);
+    create_encoded_trajectory(ds, nt, ".", 8, 1, &keyframes_tr);
+    create_encoded_trajectory(ds, nt, ".", 9, 8, &encoded_tr);
+    for (int s = 0; s < 4 * STEPS; s++)
+    {
+        double io[1] = { s < 2 * STEPS ? 5.0 : 0.0 };
+        update_conductance(ns, lcc);
+        voltage_stimulation(ns, lcc, it, io);
+
+        append_state(&raw_tr, ns, s);
+        append_state(&keyframes_tr, ns, s);
+        append_state(&encoded_tr, ns, s);
+    }
+
+    assert(keyframes_tr.end <= raw_tr.end, -1, INT_ERROR, "keyframes_tr.end", (int)raw_tr.end, (int)keyframes_tr.end);
+
+    // the junctions change at each step, but their update is replayed from
+    // the previous record: the deltas contain only the voltages, and the
+    // keyframes the entropy of the values
+    double ratio = (double)raw_tr.end / encoded_tr.end;
+    assert(ratio >= 5, -1, DOUBLE_ERROR, "ratio", 5.0, ratio);
+
+    network_state last;
+    assert(read_state(encoded_tr, 4 * STEPS - 1, &last) == 0, -1, "The last state cannot be read!\n");
+    bool equal = memcmp(last.Ys, ns.Ys, nt.js_count * sizeof(double)) == 0;
+    equal = equal && memcmp(last.Vs, ns.Vs, ds.wires_count * sizeof(double)) == 0;
+    assert(equal, -1, "The last state is not decoded losslessly!\n");
+    destroy_state(last);
+
+    close_trajectory(raw_tr);
+    close_trajectory(keyframes_tr);
+    close_trajectory(encoded_tr);
+
+    for (int i = 0; i < ccs_count; i++)
+    {
+        free(ccs[i].Is);
+    }
+    free(ccs);
+    destroy_state(ns);
+    destroy_topology(nt);
+}
+
+/**
+ * Testing that the records of a trajectory interrupted while writing its
+ * footer are recovered, without indexing the footer as a record, also when
+ * the footer is larger than a record.
+ */
+void test_partial_footer()
+{
+    // the containers depend only on the junctions and the number of nanowires
+    const datasheet ds = { .wires_count = 2 };
+    junction js[1] = { { 0, 1, { } } };
+    const network_topology nt = { NULL, 1, js };
+    double Ys[1], Vs[2];
+    const network_state ns = { Ys, Vs };
+
+    for (int keyframe_period = 0; keyframe_period <= 4; keyframe_period += 4)
+    {
+        trajectory tr;
+        int result = keyframe_period == 0
+            ? create_trajectory(ds, nt, ".", 5, &tr)
+            : create_encoded_trajectory(ds, nt, ".", 5, keyframe_period, &tr);
+        assert(result == 0, -1, "The trajectory cannot be created!\n");
+        for (int s = 0; s < STEPS; s++)
+        {
+            fill_state(ns, nt.js_count, ds.wires_count, s);
+            append_state(&tr, ns, s);
+        }
+        long long end = tr.end;
+        assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+
+        // cut the footer before its marker
+        char name[100];
+        snprintf(name, 100, TRAJECTORY_FILE_NAME_FORMAT, ".", 5);
+        FILE* file = fopen(name, "r+b");
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        assert(size - end > (long long)(2 * sizeof(int) + 3 * sizeof(double)), -1, "The footer is smaller than a record!\n");
+        assert(ftruncate(fileno(file), size - 1) == 0, -1, "The footer cannot be cut!\n");
+        fclose(file);
+
+        assert(open_trajectory(ds, nt, ".", 5, &tr) == 0, -1, "The trajectory cannot be opened!\n");
+        assert(tr.records_count == STEPS, -1, INT_ERROR, "tr.records_count", STEPS, tr.records_count);
+        assert(tr.end == end, -1, INT_ERROR, "tr.end", (int)end, (int)tr.end);
+        for (int s = 0; s < STEPS; s++)
+        {
+            check_state(tr, s);
+        }
+        assert(close_trajectory(tr) == 0, -1, "The trajectory cannot be closed!\n");
+    }
+}
+
+/**
+ * Testing that the failure to write the footer is reported.
+ */
+void test_close_failure()
+{
+    const datasheet ds = { .wires_count = 2 };
+    const network_topology nt = { NULL, 1, NULL };
+
+    trajectory tr;
+    assert(create_trajectory(ds, nt, ".", 6, &tr) == 0, -1, "The trajectory cannot be created!\n");
+
+    // a device on which every write fails for lack of space
+    FILE* full = fopen("/dev/full", "wb");
+    if (full == NULL)
+    {
+        close_trajectory(tr);
+        return;
+    }
+    fclose(tr.file);
+    tr.file = full;
+
+    assert(close_trajectory(tr) == -1, -1, "The failure to write the footer has not been reported!\n");
+}
+
+int io_trajectory()
+{
+    test_trajectory_io();
+    test_trajectory_recovery();
+    test_encoded_trajectory();
+    test_simulated_trajectory();
+    test_partial_footer();
+    test_close_failure();
+
+    return 0;
+}
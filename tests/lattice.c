@@ -0,0 +1,35 @@
+#include "config.h"
+#include "tests.h"
+
+int build_lattice(int side, int Is[], wire ws[])
+{
+    const point p = { -1, -1 };
+
+    int js_count = 0;
+    for (int i = 0; i < side * side; i++)
+    {
+        if (ws != NULL)
+        {
+            ws[i] = (wire) { (point) { i % side, i / side }, p, p, 1 };
+        }
+
+        if (i % side + 1 < side)
+        {
+            Is[js_count++] = i * side * side + i + 1;
+        }
+        if (i + side < side * side)
+        {
+            Is[js_count++] = i * side * side + i + side;
+        }
+    }
+
+    return js_count;
+}
+
+void vary_conductances(double Ys[], int js_count, int shift)
+{
+    for (int k = 0; k < js_count; k++)
+    {
+        Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * ((k + shift) % 7) / 7;
+    }
+}
@@ -0,0 +1,117 @@
+#include <math.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/ensemble.h"
+#include "stimulator/mna.h"
+#include "stimulator/pattern.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 5
+
+// number of members of the ensemble used in the tests
+#define MEMBERS 5
+
+/**
+ * Testing that each member of an ensemble, with its own initial conductance
+ * and input, follows the stimulation and update of a separate network.
+ */
+void test_ensemble_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double Ys[MEMBERS][2 * SIDE * SIDE], Vs[MEMBERS][SIDE * SIDE] = { };
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int m = 0; m < MEMBERS; m++)
+    {
+        vary_conductances(Ys[m], js_count, m);
+    }
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[2] = { 0, 12 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    int loads[1] = { 20 };
+    double weights[1] = { 0.05 };
+    interface it = { 2, sources, 1, grounds, 1, loads, weights };
+
+    // the members share the cached system, created with the first of them
+    mna_pattern mp;
+    network_state ns = { Ys[0], Vs[0] };
+    assert(create_pattern(ns, cc, it, (mna_settings){ }, &mp) == 0, -1, "The MNA pattern cannot be created!\n");
+
+    ensemble_state es = create_ensemble(ns, cc, MEMBERS);
+    for (int m = 1; m < MEMBERS; m++)
+    {
+        for (int k = 0; k < js_count; k++)
+        {
+            es.Ys[k * MEMBERS + m] = Ys[m][k];
+        }
+    }
+
+    update_kernel kernel = best_update_kernel();
+    double expected_Ys[2 * SIDE * SIDE], expected_Vs[SIDE * SIDE];
+    network_state expected_ns = { expected_Ys, expected_Vs };
+
+    for (int n = 0; n < 50; n++)
+    {
+        double ios[2 * MEMBERS], expected_ios[MEMBERS][2];
+        for (int m = 0; m < MEMBERS; m++)
+        {
+            ios[m] = expected_ios[m][0] = 2 + m;
+            ios[MEMBERS + m] = expected_ios[m][1] = n % 10 < 5 ? 1 : 0;
+        }
+
+        // step each member separately
+        for (int m = 0; m < MEMBERS; m++)
+        {
+            ns = (network_state){ Ys[m], Vs[m] };
+            refill_pattern(ns, cc, mp);
+            assert(pattern_stimulation(ns, cc, it, expected_ios[m], mp) == 0, -1, "The MNA pattern cannot be solved!\n");
+            update_conductance(ns, cc);
+        }
+        refill_pattern((network_state){ Ys[0], Vs[0] }, cc, mp);
+
+        // step the ensemble
+        assert(ensemble_stimulation(es, cc, it, ios, mp) == 0, -1, "The ensemble cannot be stimulated!\n");
+        ensemble_update(es, cc, kernel);
+
+        for (int m = 0; m < MEMBERS; m++)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                double error = fabs(expected_ios[m][i] - ios[i * MEMBERS + m]);
+                assert(error < TOLERANCE, -1, DOUBLE_ERROR, "ios[i]", expected_ios[m][i], ios[i * MEMBERS + m]);
+            }
+        }
+    }
+
+    for (int m = 0; m < MEMBERS; m++)
+    {
+        member_state(es, cc, m, expected_ns);
+
+        for (int k = 0; k < js_count; k++)
+        {
+            double error = fabs(Ys[m][k] - expected_Ys[k]) / Ys[m][k];
+            assert(error < TOLERANCE, -1, DOUBLE_ERROR, "Ys[k]", Ys[m][k], expected_Ys[k]);
+        }
+        for (int i = 0; i < SIDE * SIDE; i++)
+        {
+            assert(fabs(Vs[m][i] - expected_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "Vs[i]", Vs[m][i], expected_Vs[i]);
+        }
+    }
+
+    destroy_ensemble(es);
+    destroy_pattern(mp);
+}
+
+int stimulator_ensemble()
+{
+    test_ensemble_stimulation();
+
+    return 0;
+}
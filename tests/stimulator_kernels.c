@@ -0,0 +1,121 @@
+#include <math.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/kernels.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-12
+
+#define WS_COUNT 40
+#define JS_COUNT 75
+
+/**
+ * Testing that the vectorized exponential of each supported kernel matches
+ * the one of the C math library within its documented accuracy, and that it
+ * saturates outside its range.
+ */
+void test_vectorized_exp()
+{
+    int n = 2003;
+    double xs[n], ys[n];
+    for (int k = 0; k < n; k++)
+    {
+        xs[k] = -708 + 1417.0 * k / (n - 1);
+    }
+
+    for (update_kernel kernel = SCALAR_KERNEL; kernel <= AVX512_KERNEL; kernel++)
+    {
+        if (!supported_update_kernel(kernel))
+        {
+            continue;
+        }
+
+        vectorized_exp(kernel, xs, ys, n);
+
+        for (int k = 0; k < n; k++)
+        {
+            double error = fabs(ys[k] - exp(xs[k])) / exp(xs[k]);
+            assert(error < 1e-15, -1, DOUBLE_ERROR, "error", 0.0, error);
+        }
+
+        double bounds[8] = { -800, -800, -800, -800, 800, 800, 800, 800 };
+        double saturated[8];
+        vectorized_exp(kernel, bounds, saturated, 8);
+
+        assert(saturated[0] == 0, -1, DOUBLE_ERROR, "saturated[0]", 0.0, saturated[0]);
+        assert(isinf(saturated[7]), -1, DOUBLE_ERROR, "saturated[7]", INFINITY, saturated[7]);
+    }
+}
+
+/**
+ * Testing that the update of each supported kernel matches the scalar one,
+ * on a CC whose junctions are not a multiple of the vector width.
+ */
+void test_vectorized_update()
+{
+    // connect each nanowire to the next one and to the third after it
+    int Is[JS_COUNT];
+    int js_count = 0;
+    for (int i = 0; i < WS_COUNT && js_count < JS_COUNT; i++)
+    {
+        for (int d = 1; d <= 3 && js_count < JS_COUNT; d += 2)
+        {
+            if (i + d < WS_COUNT)
+            {
+                Is[js_count++] = i * WS_COUNT + i + d;
+            }
+        }
+    }
+    connected_component cc = { WS_COUNT, js_count, 0, 0, Is };
+
+    double Vs[WS_COUNT];
+    for (int i = 0; i < WS_COUNT; i++)
+    {
+        Vs[i] = 5 * fabs(sin(i));
+    }
+
+    for (update_kernel kernel = SCALAR_KERNEL; kernel <= AVX512_KERNEL; kernel++)
+    {
+        if (!supported_update_kernel(kernel))
+        {
+            continue;
+        }
+
+        double scalar_Ys[JS_COUNT], vectorized_Ys[JS_COUNT];
+        for (int k = 0; k < js_count; k++)
+        {
+            scalar_Ys[k] = vectorized_Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * k / js_count;
+        }
+
+        network_state scalar_ns = { scalar_Ys, Vs };
+        network_state vectorized_ns = { vectorized_Ys, Vs };
+
+        update_plan up;
+        assert(create_update_plan(cc, kernel, &up) == 0, -1, "The update plan cannot be created!\n");
+
+        for (int n = 0; n < 100; n++)
+        {
+            update_conductance(scalar_ns, cc);
+            vectorized_update(vectorized_ns, up);
+        }
+
+        for (int k = 0; k < js_count; k++)
+        {
+            double error = fabs(scalar_Ys[k] - vectorized_Ys[k]) / scalar_Ys[k];
+            assert(error < TOLERANCE, -1, DOUBLE_ERROR, "vectorized_Ys[k]", scalar_Ys[k], vectorized_Ys[k]);
+        }
+
+        destroy_update_plan(up);
+    }
+}
+
+int stimulator_kernels()
+{
+    test_vectorized_exp();
+    test_vectorized_update();
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <math.h>
+
+#include "device/network.h"
+#include "stimulator/kron.h"
+#include "stimulator/mna.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 6
+
+/**
+ * Testing that the Kron reduction of a lattice of nanowires with two sources,
+ * a ground, and a load reproduces the currents and the voltages of the MNA
+ * for different inputs.
+ */
+void test_kron_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double Ys[2 * SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    vary_conductances(Ys, js_count, 0);
+
+    double default_Vs[SIDE * SIDE], kron_Vs[SIDE * SIDE];
+    network_state default_ns = { Ys, default_Vs };
+    network_state kron_ns = { Ys, kron_Vs };
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[2] = { 0, SIDE - 1 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    int loads[1] = { SIDE * (SIDE - 1) };
+    double weights[1] = { 0.05 };
+    interface it = { 2, sources, 1, grounds, 1, loads, weights };
+
+    kron_reduction electrodes_kr, full_kr;
+    int result = kron_reduce(kron_ns, cc, it, false, (mna_settings){ }, &electrodes_kr);
+    assert(result == 0, -1, INT_ERROR, "result", 0, result);
+    result = kron_reduce(kron_ns, cc, it, true, (mna_settings){ }, &full_kr);
+    assert(result == 0, -1, INT_ERROR, "result", 0, result);
+
+    assert(electrodes_kr.ws_count == 4, -1, INT_ERROR, "electrodes_kr.ws_count", 4, electrodes_kr.ws_count);
+    assert(full_kr.ws_count == SIDE * SIDE, -1, INT_ERROR, "full_kr.ws_count", SIDE * SIDE, full_kr.ws_count);
+
+    double inputs[3][2] = { { 5, 0 }, { 1, -2 }, { 3, 3 } };
+    for (int n = 0; n < 3; n++)
+    {
+        double default_io[2] = { inputs[n][0], inputs[n][1] };
+        double electrodes_io[2] = { inputs[n][0], inputs[n][1] };
+        double full_io[2] = { inputs[n][0], inputs[n][1] };
+
+        voltage_stimulation(default_ns, cc, it, default_io);
+
+        kron_stimulation(kron_ns, electrodes_kr, electrodes_io);
+        double load_V = kron_Vs[loads[0]];
+        assert(fabs(default_Vs[loads[0]] - load_V) < TOLERANCE, -1, DOUBLE_ERROR, "load voltage", default_Vs[loads[0]], load_V);
+
+        kron_stimulation(kron_ns, full_kr, full_io);
+        for (int i = 0; i < SIDE * SIDE; i++)
+        {
+            assert(fabs(default_Vs[i] - kron_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "kron_Vs[i]", default_Vs[i], kron_Vs[i]);
+        }
+
+        for (int s = 0; s < 2; s++)
+        {
+            assert(fabs(default_io[s] - electrodes_io[s]) < TOLERANCE, -1, DOUBLE_ERROR, "electrodes_io[s]", default_io[s], electrodes_io[s]);
+            assert(fabs(default_io[s] - full_io[s]) < TOLERANCE, -1, DOUBLE_ERROR, "full_io[s]", default_io[s], full_io[s]);
+        }
+    }
+
+    destroy_kron_reduction(electrodes_kr);
+    destroy_kron_reduction(full_kr);
+}
+
+int stimulator_kron()
+{
+    test_kron_stimulation();
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <math.h>
+
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/ordering.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 8
+
+/**
+ * Testing the ordering of the following chain:
+ *
+ *      0-----1-----2-- ... --39
+ *
+ * The middle nanowire separates the two halves and is eliminated last.
+ */
+void test_chain_ordering()
+{
+    const point p = { -1, -1 };
+
+    wire ws[40];
+    int Is[39];
+    for (int i = 0; i < 40; i++)
+    {
+        ws[i] = (wire) { (point) { i, 0 }, p, p, 1 };
+    }
+    for (int i = 0; i < 39; i++)
+    {
+        Is[i] = i * 40 + i + 1;
+    }
+
+    network_topology nt = { ws, 39, NULL };
+    connected_component cc = { 40, 39, 0, 0, Is };
+
+    int Qs[40];
+    geometric_ordering(nt, cc, Qs);
+
+    // check that the ordering is a permutation of the nanowires
+    int seen[40] = { };
+    for (int i = 0; i < 40; i++)
+    {
+        assert(0 <= Qs[i] && Qs[i] < 40, -1, INT_ERROR, "range of Qs[i]", 0, Qs[i]);
+        seen[Qs[i]]++;
+    }
+    for (int i = 0; i < 40; i++)
+    {
+        assert(seen[i] == 1, -1, INT_ERROR, "occurrences of nanowire i", 1, seen[i]);
+    }
+
+    // the top separator is the last eliminated
+    assert(Qs[39] == 19, -1, INT_ERROR, "Qs[39]", 19, Qs[39]);
+}
+
+/**
+ * Testing that the stimulation of a lattice of nanowires produces the same
+ * voltages with and without the geometric ordering.
+ */
+void test_ordered_stimulation()
+{
+    wire ws[SIDE * SIDE];
+    int Is[2 * SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, ws);
+
+    double Ys[2 * SIDE * SIDE];
+    for (int k = 0; k < js_count; k++)
+    {
+        Ys[k] = 1.0 + k % 3;
+    }
+    double default_Vs[SIDE * SIDE], ordered_Vs[SIDE * SIDE];
+
+    network_topology nt = { ws, js_count, NULL };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = (interface) {
+        1, sources,
+        1, grounds,
+        0, NULL, NULL
+    };
+
+    int Qs[SIDE * SIDE];
+    geometric_ordering(nt, cc, Qs);
+
+    double default_io[1] = { 5 }, ordered_io[1] = { 5 };
+    voltage_stimulation(
+        (network_state){ Ys, default_Vs }, cc, it, default_io
+    );
+    voltage_stimulation_with(
+        (network_state){ Ys, ordered_Vs }, cc, it, ordered_io, (mna_settings){ .Qs = Qs }
+    );
+
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        assert(fabs(default_Vs[i] - ordered_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "ordered_Vs[i]", default_Vs[i], ordered_Vs[i]);
+    }
+    assert(fabs(default_io[0] - ordered_io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "ordered_io[0]", default_io[0], ordered_io[0]);
+}
+
+/**
+ * Testing that the partition of a lattice of nanowires produces subdomains
+ * connected only through the interface.
+ */
+void test_spatial_partition()
+{
+    wire ws[SIDE * SIDE];
+    int Is[2 * SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, ws);
+
+    network_topology nt = { ws, js_count, NULL };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int Ds[SIDE * SIDE];
+    spatial_partition(nt, cc, 4, Ds);
+
+    // check that each domain is used and that the interface is not empty
+    int counts[5] = { };
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        assert(-1 <= Ds[i] && Ds[i] < 4, -1, INT_ERROR, "range of Ds[i]", 0, Ds[i]);
+        counts[Ds[i] + 1]++;
+    }
+    for (int d = 0; d < 5; d++)
+    {
+        assert(counts[d] > 0, -1, INT_ERROR, "size of domain d", 1, counts[d]);
+    }
+
+    // check that no junction connects two different subdomains
+    for (int k = 0; k < js_count; k++)
+    {
+        int i = Is[k] / cc.ws_count;
+        int j = Is[k] % cc.ws_count;
+
+        assert(Ds[i] < 0 || Ds[j] < 0 || Ds[i] == Ds[j], -1, INT_ERROR, "Ds[j]", Ds[i], Ds[j]);
+    }
+}
+
+int stimulator_ordering()
+{
+    test_chain_ordering();
+    test_ordered_stimulation();
+    test_spatial_partition();
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <math.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/pattern.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 5
+
+/**
+ * Testing that the stimulation through the cached MNA system is the same of
+ * the standard one, with sources, grounds and loads.
+ */
+void test_pattern_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double Ys[2 * SIDE * SIDE], expected_Vs[SIDE * SIDE], Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    vary_conductances(Ys, js_count, 0);
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+    network_state expected_ns = { Ys, expected_Vs };
+    network_state ns = { Ys, Vs };
+
+    int sources[2] = { 0, 12 };
+    int grounds[2] = { 4, SIDE * SIDE - 1 };
+    int loads[1] = { 20 };
+    double weights[1] = { 0.05 };
+    interface it = { 2, sources, 2, grounds, 1, loads, weights };
+
+    double expected_io[2] = { 5, 2 };
+    assert(voltage_stimulation(expected_ns, cc, it, expected_io) == 0, -1, "The MNA system cannot be solved!\n");
+
+    mna_pattern mp;
+    assert(create_pattern(ns, cc, it, (mna_settings){ }, &mp) == 0, -1, "The MNA pattern cannot be created!\n");
+
+    double io[2] = { 5, 2 };
+    assert(pattern_stimulation(ns, cc, it, io, mp) == 0, -1, "The MNA pattern cannot be solved!\n");
+
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        assert(fabs(expected_Vs[i] - Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "Vs[i]", expected_Vs[i], Vs[i]);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        assert(fabs(expected_io[i] - io[i]) < TOLERANCE, -1, DOUBLE_ERROR, "io[i]", expected_io[i], io[i]);
+    }
+
+    destroy_pattern(mp);
+}
+
+/**
+ * Testing that the fused update and refill of the cached MNA system follows
+ * the separate update and stimulation of the network.
+ */
+void test_fused_update()
+{
+    int Is[2 * SIDE * SIDE];
+    double expected_Ys[2 * SIDE * SIDE], Ys[2 * SIDE * SIDE];
+    double expected_Vs[SIDE * SIDE], Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    vary_conductances(expected_Ys, js_count, 0);
+    vary_conductances(Ys, js_count, 0);
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+    network_state expected_ns = { expected_Ys, expected_Vs };
+    network_state ns = { Ys, Vs };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    mna_pattern mp;
+    assert(create_pattern(ns, cc, it, (mna_settings){ }, &mp) == 0, -1, "The MNA pattern cannot be created!\n");
+
+    for (int n = 0; n < 100; n++)
+    {
+        double expected_io[1] = { 6 }, io[1] = { 6 };
+
+        voltage_stimulation(expected_ns, cc, it, expected_io);
+        update_conductance(expected_ns, cc);
+
+        pattern_stimulation(ns, cc, it, io, mp);
+        fused_update(ns, cc, mp);
+
+        assert(fabs(expected_io[0] - io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "io[0]", expected_io[0], io[0]);
+    }
+
+    for (int k = 0; k < js_count; k++)
+    {
+        assert(fabs(expected_Ys[k] - Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "Ys[k]", expected_Ys[k], Ys[k]);
+    }
+
+    destroy_pattern(mp);
+}
+
+/**
+ * Testing that the predicted stimulation of a slowly varying input follows
+ * the exact one within the tolerance, while skipping most of the solutions.
+ */
+void test_predicted_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double expected_Ys[2 * SIDE * SIDE], Ys[2 * SIDE * SIDE];
+    double expected_Vs[SIDE * SIDE], Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    vary_conductances(expected_Ys, js_count, 0);
+    vary_conductances(Ys, js_count, 0);
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+    network_state expected_ns = { expected_Ys, expected_Vs };
+    network_state ns = { Ys, Vs };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    mna_pattern expected_mp, mp;
+    assert(create_pattern(expected_ns, cc, it, (mna_settings){ }, &expected_mp) == 0, -1, "The MNA pattern cannot be created!\n");
+    assert(create_pattern(ns, cc, it, (mna_settings){ }, &mp) == 0, -1, "The MNA pattern cannot be created!\n");
+
+    predictor pr = create_predictor(mp, 2, 1e-4);
+
+    int steps = 300;
+    for (int n = 0; n < steps; n++)
+    {
+        double v = 3 + sin(2 * M_PI * n / steps);
+        double expected_io[1] = { v }, io[1] = { v };
+
+        pattern_stimulation(expected_ns, cc, it, expected_io, expected_mp);
+        fused_update(expected_ns, cc, expected_mp);
+
+        predicted_stimulation(ns, cc, it, io, mp, &pr);
+        fused_update(ns, cc, mp);
+    }
+
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        assert(fabs(expected_Vs[i] - Vs[i]) < 1e-3, -1, DOUBLE_ERROR, "Vs[i]", expected_Vs[i], Vs[i]);
+    }
+    assert(pr.skips_count > pr.solves_count, -1, INT_ERROR, "pr.skips_count", (int)pr.solves_count, (int)pr.skips_count);
+
+    destroy_predictor(pr);
+    destroy_pattern(expected_mp);
+    destroy_pattern(mp);
+}
+
+int stimulator_pattern()
+{
+    test_pattern_stimulation();
+    test_fused_update();
+    test_predicted_stimulation();
+
+    return 0;
+}
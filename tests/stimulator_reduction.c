@@ -0,0 +1,376 @@
+#include <math.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/reduction.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+/**
+ * The circuit used in the tests: a loop between the source (S) and the
+ * ground (G) with a tree hanging from the nanowire 2.
+ *
+ *      S                 G
+ *      0-----1-----2-----3
+ *            |     |     |
+ *            |     4     |
+ *            |    / \    |
+ *            |   5   6   |
+ *            |       |   |
+ *            |       7   |
+ *            -------------
+ *
+ * (the nanowire 1 is directly connected to the nanowire 3)
+ */
+#define WS_COUNT 8
+#define JS_COUNT 8
+
+static int Is[JS_COUNT] = {
+    0 * WS_COUNT + 1,
+    1 * WS_COUNT + 2,
+    1 * WS_COUNT + 3,
+    2 * WS_COUNT + 3,
+    2 * WS_COUNT + 4,
+    4 * WS_COUNT + 5,
+    4 * WS_COUNT + 6,
+    6 * WS_COUNT + 7
+};
+
+static double Ys[JS_COUNT] = { 1, 2, 0.5, 3, 1, 2, 4, 0.25 };
+
+/**
+ * Testing that the tree hanging from the nanowire 2 is pruned and anchored to
+ * it.
+ */
+void test_dangling_tree_pruning()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { 3 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    reduced_component rc = reduce_component(cc, it, DANGLING_TREES);
+
+    assert(rc.cc.ws_count == 4, -1, INT_ERROR, "rc.cc.ws_count", 4, rc.cc.ws_count);
+    assert(rc.cc.js_count == 4, -1, INT_ERROR, "rc.cc.js_count", 4, rc.cc.js_count);
+
+    for (int i = 4; i < WS_COUNT; i++)
+    {
+        assert(rc.w2r[i] == -1, -1, INT_ERROR, "rc.w2r[i]", -1, rc.w2r[i]);
+        assert(rc.anchor[i] == 2, -1, INT_ERROR, "rc.anchor[i]", 2, rc.anchor[i]);
+    }
+
+    destroy_reduction(rc);
+}
+
+/**
+ * Testing that the stimulation of the reduced circuit produces the same
+ * voltages and currents of the original one, also when a load keeps part of
+ * the tree in the reduced circuit.
+ */
+void test_reduced_stimulation()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { 3 };
+    int loads[1] = { 7 };
+    double weights[1] = { 0.5 };
+
+    // the passes to apply and the expected size of the reduced circuit
+    // without and with the load: the load keeps the branch 4-6-7, and the
+    // series reduction collapses the nanowires 2 (and 4-6)
+    int passes[2] = { DANGLING_TREES, DANGLING_TREES | SERIES_PARALLEL };
+    int expected[2][2] = { { 4, 7 }, { 3, 5 } };
+
+    for (int p = 0; p < 2; p++)
+    for (int l = 0; l <= 1; l++)
+    {
+        interface it = { 1, sources, 1, grounds, l, loads, weights };
+
+        reduced_component rc = reduce_component(cc, it, passes[p]);
+        assert(rc.cc.ws_count == expected[p][l], -1, INT_ERROR, "rc.cc.ws_count", expected[p][l], rc.cc.ws_count);
+
+        double default_Vs[WS_COUNT], reduced_Vs[WS_COUNT];
+        double default_io[1] = { 5 }, reduced_io[1] = { 5 };
+
+        voltage_stimulation(
+            (network_state){ Ys, default_Vs }, cc, it, default_io
+        );
+        voltage_stimulation_with(
+            (network_state){ Ys, reduced_Vs }, cc, it, reduced_io, (mna_settings){ .reduction = &rc }
+        );
+
+        for (int i = 0; i < WS_COUNT; i++)
+        {
+            assert(fabs(default_Vs[i] - reduced_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_Vs[i]", default_Vs[i], reduced_Vs[i]);
+        }
+        assert(fabs(default_io[0] - reduced_io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_io[0]", default_io[0], reduced_io[0]);
+
+        destroy_reduction(rc);
+    }
+}
+
+/**
+ * Testing the series and parallel reduction of the following circuit, in
+ * which the nanowire 8 hangs from the nanowire 3, and the nanowires 6 and 7
+ * form a closed chain on the source:
+ *
+ *        6--7
+ *         \/
+ *      S   0-----------1   G
+ *          |\         /|
+ *          | \---5---/ |
+ *          |           |
+ *          2---3---4----
+ *              |
+ *              8
+ *
+ * The whole circuit collapses in a single junction made of three terms.
+ */
+void test_series_parallel()
+{
+    int Is[11] = {
+        0 * 9 + 1, 0 * 9 + 2, 0 * 9 + 5, 0 * 9 + 6, 0 * 9 + 7, 1 * 9 + 4,
+        1 * 9 + 5, 2 * 9 + 3, 3 * 9 + 4, 3 * 9 + 8, 6 * 9 + 7
+    };
+    double Ys[11] = { 1, 2, 0.5, 3, 1, 2, 4, 0.25, 1.5, 2, 0.75 };
+    double default_Vs[9], reduced_Vs[9];
+
+    connected_component cc = { 9, 11, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    reduced_component rc = reduce_component(cc, it, DANGLING_TREES | SERIES_PARALLEL);
+
+    assert(rc.cc.ws_count == 2, -1, INT_ERROR, "rc.cc.ws_count", 2, rc.cc.ws_count);
+    assert(rc.cc.js_count == 1, -1, INT_ERROR, "rc.cc.js_count", 1, rc.cc.js_count);
+    assert(rc.Tp[1] == 3, -1, INT_ERROR, "rc.Tp[1]", 3, rc.Tp[1]);
+    assert(rc.anchor[7] == 0, -1, INT_ERROR, "rc.anchor[7]", 0, rc.anchor[7]);
+    assert(rc.anchor[8] == 3, -1, INT_ERROR, "rc.anchor[8]", 3, rc.anchor[8]);
+
+    double default_io[1] = { 5 }, reduced_io[1] = { 5 };
+    voltage_stimulation(
+        (network_state){ Ys, default_Vs }, cc, it, default_io
+    );
+    voltage_stimulation_with(
+        (network_state){ Ys, reduced_Vs }, cc, it, reduced_io, (mna_settings){ .reduction = &rc }
+    );
+
+    for (int i = 0; i < 9; i++)
+    {
+        assert(fabs(default_Vs[i] - reduced_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_Vs[i]", default_Vs[i], reduced_Vs[i]);
+    }
+    assert(fabs(default_io[0] - reduced_io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_io[0]", default_io[0], reduced_io[0]);
+
+    destroy_reduction(rc);
+}
+
+/**
+ * Testing the pruning of the passive blocks of the following circuit, in
+ * which the blocks 2-4-5 and 1-7-8 are cycles hanging from the core between
+ * the source and the ground:
+ *
+ *          S
+ *          0
+ *         / \
+ *    4---2   3
+ *     \ / \ /
+ *      5   1---7
+ *      |    \ /
+ *      6     8
+ *
+ * A load on the nanowire 8 makes its block carry current.
+ */
+void test_passive_blocks()
+{
+    int Is[11] = {
+        0 * 9 + 2, 0 * 9 + 3, 1 * 9 + 2, 1 * 9 + 3, 1 * 9 + 7, 1 * 9 + 8,
+        2 * 9 + 4, 2 * 9 + 5, 4 * 9 + 5, 5 * 9 + 6, 7 * 9 + 8
+    };
+    double Ys[11] = { 1, 2, 0.5, 3, 1, 2, 4, 0.25, 1.5, 2, 0.75 };
+    double default_Vs[9], reduced_Vs[9];
+
+    connected_component cc = { 9, 11, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { 1 };
+    int loads[1] = { 8 };
+    double weights[1] = { 0.5 };
+
+    for (int l = 0; l <= 1; l++)
+    {
+        interface it = { 1, sources, 1, grounds, l, loads, weights };
+
+        reduced_component rc = reduce_component(cc, it, PASSIVE_BLOCKS);
+
+        int expected = l ? 6 : 4;
+        assert(rc.cc.ws_count == expected, -1, INT_ERROR, "rc.cc.ws_count", expected, rc.cc.ws_count);
+        for (int i = 4; i <= 6; i++)
+        {
+            assert(rc.anchor[i] == 2, -1, INT_ERROR, "rc.anchor[i]", 2, rc.anchor[i]);
+        }
+
+        double default_io[1] = { 5 }, reduced_io[1] = { 5 };
+        voltage_stimulation(
+            (network_state){ Ys, default_Vs }, cc, it, default_io
+        );
+        voltage_stimulation_with(
+            (network_state){ Ys, reduced_Vs }, cc, it, reduced_io, (mna_settings){ .reduction = &rc }
+        );
+
+        for (int i = 0; i < 9; i++)
+        {
+            assert(fabs(default_Vs[i] - reduced_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_Vs[i]", default_Vs[i], reduced_Vs[i]);
+        }
+        assert(fabs(default_io[0] - reduced_io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "reduced_io[0]", default_io[0], reduced_io[0]);
+
+        destroy_reduction(rc);
+    }
+}
+
+/**
+ * Testing the contraction of a lattice of nanowires in which a quarter of the
+ * junctions is saturated and another quarter is at its minimum conductance.
+ * The contracted stimulation must be close to the exact one (within 10% of
+ * the source voltage), and the error estimate must match the magnitude of its
+ * error.
+ */
+void test_saturated_contraction()
+{
+    const int side = 8, n = side * side;
+
+    int Is[2 * n];
+    int js_count = build_lattice(side, Is, NULL);
+
+    double Ys[2 * n];
+    for (int k = 0; k < js_count; k++)
+    {
+        Ys[k] = k % 4 == 0 ? Y_MAX : k % 4 == 1 ? Y_MIN : 0.02;
+    }
+    double default_Vs[n], contracted_Vs[n];
+
+    connected_component cc = { n, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { n - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    network_state default_ns = { Ys, default_Vs };
+    network_state contracted_ns = { Ys, contracted_Vs };
+
+    reduced_component rc = contract_component(default_ns, cc, it, 0.05, 0.05);
+    assert(rc.cc.ws_count < n, -1, INT_ERROR, "rc.cc.ws_count", n - 1, rc.cc.ws_count);
+
+    double default_io[1] = { 5 }, contracted_io[1] = { 5 };
+    voltage_stimulation(default_ns, cc, it, default_io);
+    int result = voltage_stimulation_with(
+        contracted_ns, cc, it, contracted_io, (mna_settings){ .reduction = &rc }
+    );
+    assert(result == 0, -1, INT_ERROR, "result", 0, result);
+
+    double exact_estimate = voltage_error_estimate(default_ns, cc, it);
+    double estimate = voltage_error_estimate(contracted_ns, cc, it);
+    assert(exact_estimate < TOLERANCE, -1, DOUBLE_ERROR, "exact_estimate", 0.0, exact_estimate);
+    assert(estimate > TOLERANCE, -1, DOUBLE_ERROR, "estimate", TOLERANCE, estimate);
+
+    double error = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double e = fabs(default_Vs[i] - contracted_Vs[i]);
+        error = e > error ? e : error;
+    }
+    assert(error < 0.5, -1, DOUBLE_ERROR, "error", 0.5, error);
+    assert(error < 10 * estimate, -1, DOUBLE_ERROR, "error", 10 * estimate, error);
+
+    destroy_reduction(rc);
+}
+
+/**
+ * Testing that a tree with a single electrode is entirely pruned:
+ *
+ *      S
+ *      0-----1-----2
+ *
+ * All the nanowires take the voltage of the source and no current flows.
+ */
+void test_single_electrode_tree()
+{
+    int Is[2] = { 0 * 3 + 1, 1 * 3 + 2 };
+    double Ys[2] = { 1, 1 };
+    double Vs[3];
+
+    connected_component cc = { 3, 2, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    interface it = { 1, sources, 0, NULL, 0, NULL, NULL };
+
+    reduced_component rc = reduce_component(cc, it, DANGLING_TREES);
+    assert(rc.cc.ws_count == 1, -1, INT_ERROR, "rc.cc.ws_count", 1, rc.cc.ws_count);
+
+    double io[1] = { 5 };
+    int result = voltage_stimulation_with(
+        (network_state){ Ys, Vs }, cc, it, io, (mna_settings){ .reduction = &rc }
+    );
+    assert(result == 0, -1, INT_ERROR, "result", 0, result);
+
+    for (int i = 0; i < 3; i++)
+    {
+        assert(fabs(Vs[i] - 5) < TOLERANCE, -1, DOUBLE_ERROR, "Vs[i]", 5.0, Vs[i]);
+    }
+    assert(fabs(io[0]) < TOLERANCE, -1, DOUBLE_ERROR, "io[0]", 0.0, io[0]);
+
+    destroy_reduction(rc);
+}
+
+/**
+ * Testing that a tree pruned to its loaded source nanowire draws the current
+ * drained by the load:
+ *
+ *      S,L
+ *      0-----1-----2
+ */
+void test_loaded_electrode_tree()
+{
+    int Is[2] = { 0 * 3 + 1, 1 * 3 + 2 };
+    double Ys[2] = { 1, 1 };
+    double Vs[3];
+
+    connected_component cc = { 3, 2, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int loads[1] = { 0 };
+    double weights[1] = { 0.25 };
+    interface it = { 1, sources, 0, NULL, 1, loads, weights };
+
+    reduced_component rc = reduce_component(cc, it, DANGLING_TREES);
+    assert(rc.cc.ws_count == 1, -1, INT_ERROR, "rc.cc.ws_count", 1, rc.cc.ws_count);
+
+    double io[1] = { 5 };
+    int result = voltage_stimulation_with(
+        (network_state){ Ys, Vs }, cc, it, io, (mna_settings){ .reduction = &rc }
+    );
+    assert(result == 0, -1, INT_ERROR, "result", 0, result);
+    assert(fabs(io[0] - 5 * 0.25) < TOLERANCE, -1, DOUBLE_ERROR, "io[0]", 5 * 0.25, io[0]);
+
+    destroy_reduction(rc);
+}
+
+int stimulator_reduction()
+{
+    test_dangling_tree_pruning();
+    test_reduced_stimulation();
+    test_series_parallel();
+    test_passive_blocks();
+    test_saturated_contraction();
+    test_single_electrode_tree();
+    test_loaded_electrode_tree();
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <math.h>
+
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/ordering.h"
+#include "stimulator/schur.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 12
+
+/**
+ * Testing the following system, decomposed in two subdomains {0, 1} and
+ * {3, 4} connected by the interface {2}:
+ *
+ *      |  2 -1  0  0  0 |   | 1 |   | 1 |
+ *      | -1  2 -1  0  0 |   | 1 |   | 0 |
+ *      |  0 -1  2 -1  0 | * | 1 | = | 0 |
+ *      |  0  0 -1  2 -1 |   | 1 |   | 0 |
+ *      |  0  0  0 -1  2 |   | 1 |   | 1 |
+ */
+void test_tridiagonal()
+{
+    int Ap[6] = { 0, 2, 5, 8, 11, 13 };
+    int Ai[13] = { 0, 1, 0, 1, 2, 1, 2, 3, 2, 3, 4, 3, 4 };
+    double Ax[13] = { 2, -1, -1, 2, -1, -1, 2, -1, -1, 2, -1, -1, 2 };
+    double b[5] = { 1, 0, 0, 0, 1 };
+    double x[5];
+    int dom[5] = { 0, 0, -1, 1, 1 };
+
+    int result = schur_solve(5, Ap, Ai, Ax, x, b, dom, 2);
+
+    assert(result == 0, -1, INT_ERROR, "result of schur_solve", 0, result);
+    for (int i = 0; i < 5; i++)
+    {
+        assert(fabs(x[i] - 1) < TOLERANCE, -1, DOUBLE_ERROR, "x[i]", 1.0, x[i]);
+    }
+}
+
+/**
+ * Testing that a system whose subdomains are directly coupled is rejected.
+ */
+void test_coupled_domains()
+{
+    int Ap[3] = { 0, 2, 4 };
+    int Ai[4] = { 0, 1, 0, 1 };
+    double Ax[4] = { 2, -1, -1, 2 };
+    double b[2] = { 1, 1 };
+    double x[2];
+    int dom[2] = { 0, 1 };
+
+    int result = schur_solve(2, Ap, Ai, Ax, x, b, dom, 2);
+
+    assert(result == -1, -1, INT_ERROR, "result of schur_solve", -1, result);
+}
+
+/**
+ * Testing that the stimulation of a lattice of nanowires produces the same
+ * voltages and currents with the direct and the domain-decomposition solvers.
+ */
+void test_schur_stimulation()
+{
+    wire ws[SIDE * SIDE];
+    int Is[2 * SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, ws);
+
+    double Ys[2 * SIDE * SIDE];
+    vary_conductances(Ys, js_count, 0);
+    double direct_Vs[SIDE * SIDE], schur_Vs[SIDE * SIDE];
+
+    network_topology nt = { ws, js_count, NULL };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[2] = { 0, SIDE - 1 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    int loads[1] = { SIDE * (SIDE - 1) };
+    double weights[1] = { 0.05 };
+    interface it = (interface) {
+        2, sources,
+        1, grounds,
+        1, loads, weights
+    };
+
+    int Ds[SIDE * SIDE];
+    spatial_partition(nt, cc, 4, Ds);
+
+    double direct_io[2] = { 5, 2 }, schur_io[2] = { 5, 2 };
+    voltage_stimulation(
+        (network_state){ Ys, direct_Vs }, cc, it, direct_io
+    );
+    int result = voltage_stimulation_with(
+        (network_state){ Ys, schur_Vs }, cc, it, schur_io,
+        (mna_settings){ .solver = SCHUR_SOLVER, .domains_count = 4, .Ds = Ds }
+    );
+
+    assert(result == 0, -1, INT_ERROR, "result of voltage_stimulation_with", 0, result);
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        assert(fabs(direct_Vs[i] - schur_Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "schur_Vs[i]", direct_Vs[i], schur_Vs[i]);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        assert(fabs(direct_io[i] - schur_io[i]) < TOLERANCE, -1, DOUBLE_ERROR, "schur_io[i]", direct_io[i], schur_io[i]);
+    }
+}
+
+/**
+ * Testing that a stimulation with a missing or out of range partition is
+ * rejected by the domain-decomposition solver.
+ */
+void test_invalid_partition()
+{
+    // a chain of three nanowires, stimulated at its ends
+    int Is[2] = { 1, 5 };
+    double Ys[2] = { 0.01, 0.01 }, Vs[3];
+    connected_component cc = { 3, 2, 0, 0, Is };
+    int sources[1] = { 0 }, grounds[1] = { 2 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+    network_state ns = { Ys, Vs };
+
+    int Ds[3] = { 0, -1, 2 };
+    double io[1] = { 1 };
+    int result = voltage_stimulation_with(ns, cc, it, io, (mna_settings){ .solver = SCHUR_SOLVER, .domains_count = 2 });
+    assert(result == -1, -1, INT_ERROR, "result of voltage_stimulation_with", -1, result);
+
+    result = voltage_stimulation_with(ns, cc, it, io, (mna_settings){ .solver = SCHUR_SOLVER, .domains_count = 0, .Ds = Ds });
+    assert(result == -1, -1, INT_ERROR, "result of voltage_stimulation_with", -1, result);
+
+    // the last nanowire is in a subdomain out of the partition
+    result = voltage_stimulation_with(ns, cc, it, io, (mna_settings){ .solver = SCHUR_SOLVER, .domains_count = 2, .Ds = Ds });
+    assert(result == -1, -1, INT_ERROR, "result of voltage_stimulation_with", -1, result);
+}
+
+int stimulator_schur()
+{
+    test_tridiagonal();
+    test_coupled_domains();
+    test_schur_stimulation();
+    test_invalid_partition();
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/session.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 5
+
+// number of sessions driven concurrently
+#define SESSIONS 4
+
+/**
+ * Testing that sessions driven concurrently from different threads produce
+ * the same results of the sequential simulation of each network.
+ */
+void test_concurrent_sessions()
+{
+    int Is[2 * SIDE * SIDE];
+    double Ys[SESSIONS][2 * SIDE * SIDE], Vs[SESSIONS][SIDE * SIDE] = { };
+    double expected_Ys[SESSIONS][2 * SIDE * SIDE], expected_Vs[SESSIONS][SIDE * SIDE] = { };
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int s = 0; s < SESSIONS; s++)
+    {
+        vary_conductances(Ys[s], js_count, s);
+        vary_conductances(expected_Ys[s], js_count, s);
+    }
+
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    int loads[1] = { 12 };
+    double weights[1] = { 0.05 };
+    interface it = { 1, sources, 1, grounds, 1, loads, weights };
+
+    // the odd sessions use a fill-reducing ordering of the nanowires
+    int Qs[SIDE * SIDE];
+    for (int i = 0; i < SIDE * SIDE; i++)
+    {
+        Qs[i] = SIDE * SIDE - 1 - i;
+    }
+
+    session ss[SESSIONS];
+    for (int s = 0; s < SESSIONS; s++)
+    {
+        network_state ns = { Ys[s], Vs[s] };
+        mna_settings settings = { .Qs = s % 2 ? Qs : NULL };
+
+        assert(create_session(ns, cc, it, settings, 1, &ss[s]) == 0, -1, "The session cannot be created: %s", ss[s].error);
+    }
+
+    double expected_io[SESSIONS][50], io[SESSIONS][50];
+
+    #pragma omp parallel for num_threads(SESSIONS)
+    for (int s = 0; s < SESSIONS; s++)
+    {
+        for (int n = 0; n < 50; n++)
+        {
+            io[s][n] = n % 10 < 5 ? 1 + s : 0;
+            session_step(&ss[s], &io[s][n]);
+        }
+    }
+
+    for (int s = 0; s < SESSIONS; s++)
+    {
+        network_state ns = { expected_Ys[s], expected_Vs[s] };
+        for (int n = 0; n < 50; n++)
+        {
+            expected_io[s][n] = n % 10 < 5 ? 1 + s : 0;
+            update_conductance(ns, cc);
+            voltage_stimulation(ns, cc, it, &expected_io[s][n]);
+
+            assert(fabs(expected_io[s][n] - io[s][n]) < TOLERANCE, -1, DOUBLE_ERROR, "io[s][n]", expected_io[s][n], io[s][n]);
+        }
+
+        for (int k = 0; k < js_count; k++)
+        {
+            assert(fabs(expected_Ys[s][k] - Ys[s][k]) < TOLERANCE, -1, DOUBLE_ERROR, "Ys[s][k]", expected_Ys[s][k], Ys[s][k]);
+        }
+
+        destroy_session(ss[s]);
+    }
+}
+
+/**
+ * Testing that the error of a session is saved in its buffer, and that the
+ * errors of the calling thread are then reported as before.
+ */
+void test_session_error()
+{
+    // the second nanowire is floating: the MNA system is singular
+    int Is[1];
+    double Ys[1], Vs[2];
+    connected_component cc = { 2, 0, 0, 0, Is };
+    network_state ns = { Ys, Vs };
+
+    int sources[1] = { 0 };
+    interface it = { 1, sources, 0, NULL, 0, NULL, NULL };
+
+    session s;
+    create_session(ns, cc, it, (mna_settings){ }, 2, &s);
+
+    double io[1] = { 1 };
+    int result = session_stimulation(&s, io);
+    assert(result == -1, -1, INT_ERROR, "result", -1, result);
+    assert(strlen(s.error) > 0, -1, "The error of the session has not been saved\n");
+
+    char* buffer = redirect_errors(NULL);
+    assert(buffer == NULL, -1, "The errors of the thread are still redirected\n");
+
+    destroy_session(s);
+}
+
+int stimulator_session()
+{
+    test_concurrent_sessions();
+    test_session_error();
+
+    return 0;
+}
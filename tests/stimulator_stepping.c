@@ -0,0 +1,368 @@
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/mna.h"
+#include "stimulator/stepping.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+// side of the squared lattice of nanowires used in the tests
+#define SIDE 6
+
+// number of steps of TAU simulated in the tests
+#define STEPS 200
+
+/**
+ * Testing that the adaptive stimulation of a lattice follows the fixed-step
+ * simulation with less voltage stimulations.
+ */
+void test_adaptive_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double fixed_Ys[2 * SIDE * SIDE], adaptive_Ys[2 * SIDE * SIDE];
+    double fixed_Vs[SIDE * SIDE], adaptive_Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int k = 0; k < js_count; k++)
+    {
+        fixed_Ys[k] = adaptive_Ys[k] = Y_MIN;
+    }
+
+    network_state fixed_ns = { fixed_Ys, fixed_Vs };
+    network_state adaptive_ns = { adaptive_Ys, adaptive_Vs };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    // fixed-step simulation: a stimulation and an update for each TAU
+    double fixed_io[1];
+    for (int n = 0; n < STEPS; n++)
+    {
+        fixed_io[0] = 8;
+        voltage_stimulation(fixed_ns, cc, it, fixed_io);
+        update_conductance(fixed_ns, cc);
+    }
+    fixed_io[0] = 8;
+    voltage_stimulation(fixed_ns, cc, it, fixed_io);
+
+    double adaptive_io[1] = { 8 };
+    int count = adaptive_stimulation(adaptive_ns, cc, it, adaptive_io, STEPS * TAU, 1e-2, (mna_settings){ });
+
+    assert(0 < count && count < STEPS, -1, INT_ERROR, "count", STEPS, count);
+
+    for (int k = 0; k < js_count; k++)
+    {
+        double error = fabs(fixed_Ys[k] - adaptive_Ys[k]) / (Y_MAX - Y_MIN);
+        assert(error < 0.05, -1, DOUBLE_ERROR, "normalized error", 0.05, error);
+    }
+    double error = fabs(fixed_io[0] - adaptive_io[0]) / fabs(fixed_io[0]);
+    assert(error < 0.05, -1, DOUBLE_ERROR, "relative current error", 0.05, error);
+}
+
+/**
+ * Testing that the steady state of a lattice under a constant stimulation is
+ * the state reached by a long fixed-step simulation, with much less voltage
+ * stimulations.
+ */
+void test_steady_state()
+{
+    int Is[2 * SIDE * SIDE];
+    double fixed_Ys[2 * SIDE * SIDE], steady_Ys[2 * SIDE * SIDE];
+    double fixed_Vs[SIDE * SIDE], steady_Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int k = 0; k < js_count; k++)
+    {
+        fixed_Ys[k] = steady_Ys[k] = Y_MIN;
+    }
+
+    network_state fixed_ns = { fixed_Ys, fixed_Vs };
+    network_state steady_ns = { steady_Ys, steady_Vs };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    double fixed_io[1];
+    for (int n = 0; n < 20 * STEPS; n++)
+    {
+        fixed_io[0] = 3;
+        voltage_stimulation(fixed_ns, cc, it, fixed_io);
+        update_conductance(fixed_ns, cc);
+    }
+    fixed_io[0] = 3;
+    voltage_stimulation(fixed_ns, cc, it, fixed_io);
+
+    double steady_io[1] = { 3 };
+    int count = steady_state(steady_ns, cc, it, steady_io, 1e-8, 100, (mna_settings){ });
+
+    assert(0 < count && count < 100, -1, INT_ERROR, "count", 100, count);
+
+    for (int k = 0; k < js_count; k++)
+    {
+        double error = fabs(fixed_Ys[k] - steady_Ys[k]) / (Y_MAX - Y_MIN);
+        assert(error < 1e-4, -1, DOUBLE_ERROR, "normalized error", 1e-4, error);
+    }
+    double error = fabs(fixed_io[0] - steady_io[0]) / fabs(fixed_io[0]);
+    assert(error < 1e-4, -1, DOUBLE_ERROR, "relative current error", 1e-4, error);
+}
+
+/**
+ * Testing that each point of a voltage sweep is a steady state, i.e., that
+ * a further update does not change the conductance of the junctions.
+ */
+void test_steady_sweep()
+{
+    int Is[2 * SIDE * SIDE];
+    double Ys[2 * SIDE * SIDE], Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int k = 0; k < js_count; k++)
+    {
+        Ys[k] = Y_MIN;
+    }
+
+    network_state ns = { Ys, Vs };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    double ios[8] = { 0.5, 1, 1.5, 2, 2.5, 3, 3.5, 4 };
+    int count = steady_sweep(ns, cc, it, ios, 8, 1e-8, 100, (mna_settings){ });
+
+    assert(0 < count, -1, INT_ERROR, "count", 1, count);
+
+    // the current grows with the voltage
+    for (int p = 1; p < 8; p++)
+    {
+        assert(fabs(ios[p]) > fabs(ios[p - 1]), -1, DOUBLE_ERROR, "fabs(ios[p])", fabs(ios[p - 1]), fabs(ios[p]));
+    }
+
+    double steady_Ys[2 * SIDE * SIDE];
+    for (int k = 0; k < js_count; k++)
+    {
+        steady_Ys[k] = Ys[k];
+    }
+    update_conductance(ns, cc);
+
+    for (int k = 0; k < js_count; k++)
+    {
+        double error = fabs(steady_Ys[k] - Ys[k]) / (Y_MAX - Y_MIN);
+        assert(error < 1e-6, -1, DOUBLE_ERROR, "normalized error", 1e-6, error);
+    }
+}
+
+/**
+ * Testing that the Parareal integration of a pulsed protocol matches its
+ * sequential simulation in less iterations than time slices.
+ */
+void test_parareal_stimulation()
+{
+    int Is[2 * SIDE * SIDE];
+    double serial_Ys[2 * SIDE * SIDE], parareal_Ys[2 * SIDE * SIDE];
+    double serial_Vs[SIDE * SIDE], parareal_Vs[SIDE * SIDE];
+    int js_count = build_lattice(SIDE, Is, NULL);
+    for (int k = 0; k < js_count; k++)
+    {
+        serial_Ys[k] = parareal_Ys[k] = Y_MIN;
+    }
+
+    network_state serial_ns = { serial_Ys, serial_Vs };
+    network_state parareal_ns = { parareal_Ys, parareal_Vs };
+    connected_component cc = { SIDE * SIDE, js_count, 0, 0, Is };
+
+    int sources[1] = { 0 };
+    int grounds[1] = { SIDE * SIDE - 1 };
+    interface it = { 1, sources, 1, grounds, 0, NULL, NULL };
+
+    // pulses of 3 volts alternated with rest periods
+    double serial_ios[2 * STEPS], parareal_ios[2 * STEPS];
+    for (int n = 0; n < 2 * STEPS; n++)
+    {
+        serial_ios[n] = parareal_ios[n] = (n / 50) % 2 ? 0 : 3;
+    }
+
+    for (int n = 0; n < 2 * STEPS; n++)
+    {
+        voltage_stimulation(serial_ns, cc, it, serial_ios + n);
+        update_conductance(serial_ns, cc);
+    }
+
+    parareal_settings ps = { 8, 10, 8, 1e-9, { } };
+    int iterations = parareal_stimulation(parareal_ns, cc, it, parareal_ios, 2 * STEPS, (mna_settings){ }, ps);
+
+    assert(0 < iterations && iterations < ps.slices_count, -1, INT_ERROR, "iterations", ps.slices_count, iterations);
+
+    for (int k = 0; k < js_count; k++)
+    {
+        double error = fabs(serial_Ys[k] - parareal_Ys[k]) / (Y_MAX - Y_MIN);
+        assert(error < 1e-6, -1, DOUBLE_ERROR, "normalized error", 1e-6, error);
+    }
+    for (int n = 0; n < 2 * STEPS; n++)
+    {
+        double error = fabs(serial_ios[n] - parareal_ios[n]);
+        assert(error < 1e-6, -1, DOUBLE_ERROR, "current error", 1e-6, error);
+    }
+}
+
+/**
+ * Testing that the step of a network with components of different sizes,
+ * one of them split among the threads and one without sources, is the same
+ * of the separate update and stimulation of each component.
+ */
+void test_network_step()
+{
+    // the first lattice is large enough to have its update split in chunks
+    int sides[4] = { 24, 5, 3, 4 };
+    int ws_count = 0, js_count = 0;
+    for (int c = 0; c < 4; c++)
+    {
+        ws_count += sides[c] * sides[c];
+        js_count += 2 * sides[c] * (sides[c] - 1);
+    }
+
+    int Is[js_count];
+    double expected_Ys[js_count], Ys[js_count];
+    double expected_Vs[ws_count], Vs[ws_count];
+    connected_component ccs[4];
+
+    for (int c = 0, ws_skip = 0, js_skip = 0; c < 4; c++)
+    {
+        int n = sides[c] * sides[c];
+        int k = js_skip + build_lattice(sides[c], Is + js_skip, NULL);
+
+        ccs[c] = (connected_component){ n, k - js_skip, ws_skip, js_skip, Is + js_skip };
+        ws_skip += n;
+        js_skip = k;
+    }
+
+    vary_conductances(Ys, js_count, 0);
+    memcpy(expected_Ys, Ys, sizeof(Ys));
+    for (int i = 0; i < ws_count; i++)
+    {
+        expected_Vs[i] = Vs[i] = 0;
+    }
+
+    network_state expected_ns = { expected_Ys, expected_Vs };
+    network_state ns = { Ys, Vs };
+
+    // the third component is not connected to any source
+    int sources[3] = { 0, 576 + 6, 576 + 25 + 9 + 1 };
+    int grounds[3] = { 575, 576 + 24, 576 + 25 + 9 + 15 };
+    int loads[1] = { 576 + 20 };
+    double weights[1] = { 0.05 };
+    interface it = { 3, sources, 3, grounds, 1, loads, weights };
+
+    step_plan sp = create_step_plan(ccs, 4, it);
+    assert(sp.chunks_count == 2, -1, INT_ERROR, "sp.chunks_count", 2, sp.chunks_count);
+
+    for (int n = 0; n < 20; n++)
+    {
+        double inputs[3] = { 5, n % 10 < 5 ? 2 : 0, 3 };
+        double expected_io[3], io[3];
+        memcpy(io, inputs, sizeof(inputs));
+
+        // each component draws the current of its own sources
+        int s2c[3] = { 0, 1, 3 };
+        for (int c = 0; c < 4; c++)
+        {
+            update_conductance(expected_ns, ccs[c]);
+        }
+        for (int c = 0; c < 4; c++)
+        {
+            double cio[3];
+            memcpy(cio, inputs, sizeof(inputs));
+            voltage_stimulation(expected_ns, ccs[c], it, cio);
+
+            for (int i = 0; i < 3; i++)
+            {
+                expected_io[i] = s2c[i] == c ? cio[i] : expected_io[i];
+            }
+        }
+
+        assert(network_step(ns, sp, io) == 0, -1, "The network step cannot be performed!\n");
+
+        for (int i = 0; i < 3; i++)
+        {
+            assert(fabs(expected_io[i] - io[i]) < 1e-9, -1, DOUBLE_ERROR, "io[i]", expected_io[i], io[i]);
+        }
+    }
+
+    for (int k = 0; k < js_count; k++)
+    {
+        assert(fabs(expected_Ys[k] - Ys[k]) < 1e-9, -1, DOUBLE_ERROR, "Ys[k]", expected_Ys[k], Ys[k]);
+    }
+    for (int i = 0; i < ws_count; i++)
+    {
+        assert(fabs(expected_Vs[i] - Vs[i]) < 1e-9, -1, DOUBLE_ERROR, "Vs[i]", expected_Vs[i], Vs[i]);
+    }
+
+    destroy_step_plan(sp);
+}
+
+/**
+ * Testing that a component split in chunks is updated by the network step
+ * also when it follows a component with more nanowires but fewer junctions.
+ */
+void test_chunked_order()
+{
+    // a chain of nanowires, larger than the lattice but with fewer junctions
+    const int chain = 600, side = 24;
+    int chain_Is[chain - 1], lattice_Is[2 * side * side];
+    for (int i = 0; i < chain - 1; i++)
+    {
+        chain_Is[i] = i * chain + i + 1;
+    }
+    int lattice_count = build_lattice(side, lattice_Is, NULL);
+
+    int js_count = chain - 1 + lattice_count;
+    double expected_Ys[js_count], Ys[js_count];
+    double Vs[chain + side * side];
+    vary_conductances(Ys, js_count, 0);
+    memcpy(expected_Ys, Ys, sizeof(Ys));
+    for (int i = 0; i < chain + side * side; i++)
+    {
+        Vs[i] = i % 5;
+    }
+
+    connected_component ccs[2] = {
+        { side * side, lattice_count, chain, chain - 1, lattice_Is },
+        { chain, chain - 1, 0, 0, chain_Is }
+    };
+    network_state expected_ns = { expected_Ys, Vs };
+    network_state ns = { Ys, Vs };
+
+    // without sources the voltages are reset after the update
+    interface it = { 0, NULL, 0, NULL, 0, NULL, NULL };
+    step_plan sp = create_step_plan(ccs, 2, it);
+    int expected = (lattice_count + 1023) / 1024;
+    assert(sp.chunks_count == expected, -1, INT_ERROR, "sp.chunks_count", expected, sp.chunks_count);
+
+    update_conductance(expected_ns, ccs[0]);
+    update_conductance(expected_ns, ccs[1]);
+    assert(network_step(ns, sp, NULL) == 0, -1, "The network step cannot be performed!\n");
+
+    for (int k = 0; k < js_count; k++)
+    {
+        assert(expected_Ys[k] == Ys[k], -1, DOUBLE_ERROR, "Ys[k]", expected_Ys[k], Ys[k]);
+    }
+
+    destroy_step_plan(sp);
+}
+
+int stimulator_stepping()
+{
+    test_adaptive_stimulation();
+    test_steady_state();
+    test_steady_sweep();
+    test_parareal_stimulation();
+    test_network_step();
+    test_chunked_order();
+
+    return 0;
+}
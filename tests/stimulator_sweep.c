@@ -0,0 +1,169 @@
+#include <math.h>
+#include <sys/stat.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "interface/mea.h"
+#include "io/deserializer.h"
+#include "stimulator/stepping.h"
+#include "stimulator/sweep.h"
+#include "tests.h"
+#include "util/components.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-9
+
+// base path of the results of the sweep
+#define PATH "sweep"
+
+// number of steps of the protocols used in the tests
+#define STEPS 10
+
+/**
+ * Testing that each job of a sweep serializes the same states and currents of
+ * the standalone simulation of its device, MEA configuration and protocol.
+ */
+void test_run_sweep()
+{
+    datasheet dss[2] = {
+        { 300, 40.0, 14.0, 150, 1 },
+        { 200, 40.0, 14.0, 150, 2 }
+    };
+
+    MEA mea = { };
+    mea.ct[0] = SOURCE;
+    mea.ct[5] = LOAD;
+    mea.ct[15] = GROUND;
+    mea.ws[5] = 0.5;
+
+    double pulses[STEPS], ramp[STEPS];
+    for (int s = 0; s < STEPS; s++)
+    {
+        pulses[s] = s % 4 < 2 ? 5 : 0;
+        ramp[s] = s / 2.0;
+    }
+    protocol prs[2] = { { STEPS, 1, pulses }, { STEPS, 1, ramp } };
+
+    mkdir(PATH, 0700);
+    sweep sw = { 2, dss, 1, &mea, 2, prs, PATH, 3, 0 };
+    assert(run_sweep(sw) == 0, -1, "The sweep cannot be executed!\n");
+
+    for (int d = 0; d < 2; d++)
+    {
+        for (int p = 0; p < 2; p++)
+        {
+            // simulate the job alone
+            int n2c[dss[d].wires_count], ccs_count;
+            network_topology nt = create_network(dss[d], n2c, &ccs_count);
+            connected_component* ccs = split_components(dss[d], nt, n2c, ccs_count);
+            network_state ns = construe_circuit(dss[d], nt);
+
+            MEA connected = connect_MEA(dss[d], nt);
+            connected.ct[0] = SOURCE;
+            connected.ct[5] = LOAD;
+            connected.ct[15] = GROUND;
+            connected.ws[5] = 0.5;
+            interface it = mea2interface(connected);
+            step_plan sp = create_step_plan(ccs, ccs_count, it);
+
+            // the currents of the job follow the version and the sources count
+            char name[100];
+            snprintf(name, 100, CURRENTS_FILE_NAME_FORMAT, PATH, sweep_job(sw, d, 0, p));
+            FILE* currents = fopen(name, "rb");
+            assert(currents != NULL, -1, "The currents of the job cannot be opened!\n");
+
+            int header[2];
+            assert(fread(header, sizeof(int), 2, currents) == 2, -1, "The header of the currents cannot be read!\n");
+            assert(header[1] == 1, -1, INT_ERROR, "header[1]", 1, header[1]);
+
+            for (int s = 0; s < STEPS; s++)
+            {
+                double io[1] = { prs[p].inputs[s] };
+                network_step(ns, sp, io);
+
+                double loaded_io;
+                assert(fread(&loaded_io, sizeof(double), 1, currents) == 1, -1, "The current of step %d cannot be read!\n", s);
+                assert(fabs(io[0] - loaded_io) < TOLERANCE, -1, DOUBLE_ERROR, "loaded_io", io[0], loaded_io);
+
+                // the snapshots are serialized every 3 steps and at the end
+                if (s % 3 != 0 && s != STEPS - 1)
+                {
+                    continue;
+                }
+
+                network_state loaded_ns;
+                deserialize_state(dss[d], nt, &loaded_ns, PATH, sweep_job(sw, d, 0, p), s);
+
+                for (int k = 0; k < nt.js_count; k++)
+                {
+                    assert(fabs(ns.Ys[k] - loaded_ns.Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "loaded_ns.Ys[k]", ns.Ys[k], loaded_ns.Ys[k]);
+                }
+                for (int i = 0; i < dss[d].wires_count; i++)
+                {
+                    assert(fabs(ns.Vs[i] - loaded_ns.Vs[i]) < TOLERANCE, -1, DOUBLE_ERROR, "loaded_ns.Vs[i]", ns.Vs[i], loaded_ns.Vs[i]);
+                }
+
+                destroy_state(loaded_ns);
+            }
+
+            assert(fgetc(currents) == EOF, -1, "The currents have more steps than the protocol!\n");
+            fclose(currents);
+
+            destroy_step_plan(sp);
+            destroy_interface(it);
+            destroy_state(ns);
+            for (int c = 0; c < ccs_count; c++)
+            {
+                destroy_component(ccs[c]);
+            }
+            free(ccs);
+            destroy_topology(nt);
+        }
+    }
+}
+
+/**
+ * Testing that a sweep whose protocols do not match the sources of the MEA is
+ * rejected.
+ */
+void test_invalid_sweep()
+{
+    datasheet ds = { 100, 40.0, 14.0, 150, 1 };
+
+    MEA mea = { };
+    mea.ct[0] = SOURCE;
+    mea.ct[1] = SOURCE;
+
+    double inputs[1] = { 1 };
+    protocol pr = { 1, 1, inputs };
+
+    sweep sw = { 1, &ds, 1, &mea, 1, &pr, PATH, 0, 0 };
+    assert(run_sweep(sw) == -1, -1, "The invalid sweep has been executed!\n");
+}
+
+/**
+ * Testing that a sweep whose results cannot be written fails without
+ * terminating the process.
+ */
+void test_unwritable_sweep()
+{
+    datasheet ds = { 100, 40.0, 14.0, 150, 1 };
+
+    MEA mea = { };
+    mea.ct[0] = SOURCE;
+
+    double inputs[1] = { 1 };
+    protocol pr = { 1, 1, inputs };
+
+    sweep sw = { 1, &ds, 1, &mea, 1, &pr, PATH "/missing_folder", 0, 0 };
+    assert(run_sweep(sw) == -1, -1, "The sweep without a folder for its results has succeeded!\n");
+}
+
+int stimulator_sweep()
+{
+    test_run_sweep();
+    test_invalid_sweep();
+    test_unwritable_sweep();
+
+    return 0;
+}
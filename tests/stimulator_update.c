@@ -0,0 +1,216 @@
+#include <math.h>
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+
+#define TOLERANCE 1e-12
+
+#define WS_COUNT 6
+#define JS_COUNT 7
+
+/**
+ * The circuit used in the tests, with a different voltage on each nanowire:
+ *
+ *      0-----1-----2
+ *      |   /       |
+ *      |  /        |
+ *      3-----4-----5
+ */
+static int Is[JS_COUNT] = {
+    0 * WS_COUNT + 1,
+    0 * WS_COUNT + 3,
+    1 * WS_COUNT + 2,
+    1 * WS_COUNT + 3,
+    2 * WS_COUNT + 5,
+    3 * WS_COUNT + 4,
+    4 * WS_COUNT + 5
+};
+
+static double Vs[WS_COUNT] = { 5, 3.2, 1.5, 0.4, 0.1, 0 };
+
+/**
+ * Testing that advancing the conductance by several steps at once is
+ * equivalent to the repeated update at fixed voltages, for both a rest
+ * period and a stimulation.
+ */
+void test_advance_conductance()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+    int steps[3] = { 0, 1, 250 };
+
+    for (int stimulated = 0; stimulated <= 1; stimulated++)
+    for (int s = 0; s < 3; s++)
+    {
+        double Vs_copy[WS_COUNT];
+        for (int i = 0; i < WS_COUNT; i++)
+        {
+            Vs_copy[i] = stimulated ? Vs[i] : 0;
+        }
+
+        double iterated_Ys[JS_COUNT], advanced_Ys[JS_COUNT];
+        for (int k = 0; k < JS_COUNT; k++)
+        {
+            iterated_Ys[k] = advanced_Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * k / JS_COUNT;
+        }
+
+        network_state iterated_ns = { iterated_Ys, Vs_copy };
+        network_state advanced_ns = { advanced_Ys, Vs_copy };
+
+        for (int n = 0; n < steps[s]; n++)
+        {
+            update_conductance(iterated_ns, cc);
+        }
+        advance_conductance(advanced_ns, cc, steps[s]);
+
+        for (int k = 0; k < JS_COUNT; k++)
+        {
+            assert(fabs(iterated_Ys[k] - advanced_Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "advanced_Ys[k]", iterated_Ys[k], advanced_Ys[k]);
+        }
+    }
+}
+
+/**
+ * Testing that the update over an arbitrary interval is consistent with the
+ * update of a single step, and that consecutive intervals compose.
+ */
+void test_update_conductance_dt()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+
+    double stepped_Ys[JS_COUNT], single_Ys[JS_COUNT], split_Ys[JS_COUNT];
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        stepped_Ys[k] = single_Ys[k] = split_Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * k / JS_COUNT;
+    }
+
+    network_state stepped_ns = { stepped_Ys, Vs };
+    network_state single_ns = { single_Ys, Vs };
+    network_state split_ns = { split_Ys, Vs };
+
+    // an interval of TAU is a single update
+    update_conductance(stepped_ns, cc);
+    update_conductance_dt(single_ns, cc, TAU);
+
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        assert(fabs(stepped_Ys[k] - single_Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "single_Ys[k]", stepped_Ys[k], single_Ys[k]);
+    }
+
+    // an interval of 2.5 TAU is equivalent to two intervals of 1.25 TAU
+    update_conductance_dt(single_ns, cc, 2.5 * TAU);
+    update_conductance_dt(split_ns, cc, TAU);
+    update_conductance_dt(split_ns, cc, 1.25 * TAU);
+    update_conductance_dt(split_ns, cc, 1.25 * TAU);
+
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        assert(fabs(split_Ys[k] - single_Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "split_Ys[k]", single_Ys[k], split_Ys[k]);
+    }
+}
+
+/**
+ * Testing that the multi-rate update follows the update of every junction at
+ * every step within the requested tolerance, while updating fewer junctions,
+ * through a ramp of the stimulation followed by a plateau.
+ */
+void test_multirate_update()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+
+    double full_Ys[JS_COUNT], multirate_Ys[JS_COUNT];
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        full_Ys[k] = multirate_Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * k / JS_COUNT;
+    }
+
+    double Vs_copy[WS_COUNT];
+    network_state full_ns = { full_Ys, Vs_copy };
+    network_state multirate_ns = { multirate_Ys, Vs_copy };
+
+    multirate_schedule ms = create_schedule(cc, 1e-3, 64, 5e-2);
+
+    int steps = 400;
+    for (int n = 0; n < steps; n++)
+    {
+        double scale = n < steps / 2 ? 2.0 * n / steps : 1;
+        for (int i = 0; i < WS_COUNT; i++)
+        {
+            Vs_copy[i] = scale * Vs[i];
+        }
+
+        update_conductance(full_ns, cc);
+        multirate_update(multirate_ns, cc, &ms);
+    }
+    flush_schedule(multirate_ns, cc, &ms);
+
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        assert(fabs(full_Ys[k] - multirate_Ys[k]) < 1e-3 * (Y_MAX - Y_MIN), -1, DOUBLE_ERROR, "multirate_Ys[k]", full_Ys[k], multirate_Ys[k]);
+    }
+    assert(ms.updates_count < steps * JS_COUNT / 2, -1, INT_ERROR, "ms.updates_count", steps * JS_COUNT / 2, (int)ms.updates_count);
+
+    destroy_schedule(ms);
+}
+
+/**
+ * Testing that the cached update is the same of the standard one, and that
+ * the coefficients are recomputed only for the junctions whose voltage drop
+ * changed.
+ */
+void test_cached_update()
+{
+    connected_component cc = { WS_COUNT, JS_COUNT, 0, 0, Is };
+
+    double full_Ys[JS_COUNT], cached_Ys[JS_COUNT];
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        full_Ys[k] = cached_Ys[k] = Y_MIN + (Y_MAX - Y_MIN) * k / JS_COUNT;
+    }
+
+    double Vs_copy[WS_COUNT];
+    for (int i = 0; i < WS_COUNT; i++)
+    {
+        Vs_copy[i] = Vs[i];
+    }
+
+    network_state full_ns = { full_Ys, Vs_copy };
+    network_state cached_ns = { cached_Ys, Vs_copy };
+
+    update_cache uc = create_update_cache(cc, 0);
+
+    for (int n = 0; n < 50; n++)
+    {
+        update_conductance(full_ns, cc);
+        cached_update(cached_ns, cc, &uc);
+    }
+    assert(uc.refreshes_count == JS_COUNT, -1, INT_ERROR, "uc.refreshes_count", JS_COUNT, (int)uc.refreshes_count);
+
+    // moving the voltage of nanowire 5 changes the drop of junctions 2-5, 4-5
+    Vs_copy[5] = 0.3;
+    for (int n = 0; n < 50; n++)
+    {
+        update_conductance(full_ns, cc);
+        cached_update(cached_ns, cc, &uc);
+    }
+    assert(uc.refreshes_count == JS_COUNT + 2, -1, INT_ERROR, "uc.refreshes_count", JS_COUNT + 2, (int)uc.refreshes_count);
+
+    for (int k = 0; k < JS_COUNT; k++)
+    {
+        assert(fabs(full_Ys[k] - cached_Ys[k]) < TOLERANCE, -1, DOUBLE_ERROR, "cached_Ys[k]", full_Ys[k], cached_Ys[k]);
+    }
+
+    destroy_update_cache(uc);
+}
+
+int stimulator_update()
+{
+    test_advance_conductance();
+    test_update_conductance_dt();
+    test_multirate_update();
+    test_cached_update();
+
+    return 0;
+}
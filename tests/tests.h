@@ -1,8 +1,34 @@
 #ifndef TESTS_H
 #define TESTS_H
 
+#include <stddef.h>
+
+#include "device/wire.h"
+
 #define INT_ERROR "Unexpected value of '%s'. Expected %d, Result %d"
 #define DOUBLE_ERROR "Unexpected value of '%s'. Expected %f, Result %f"
 #define POINTER_ERROR "Unexpected value of '%s'. Expected %p, Result %p"
 
+/**
+ * Build a side x side lattice of nanowires, in which each nanowire is
+ * connected to its right and lower neighbours.
+ *
+ * @param side The number of nanowires on a side of the lattice.
+ * @param Is The junctions of the lattice, as in a connected component. It
+ * must contain at least 2 * side * side entries.
+ * @param ws The nanowires, placed on the points of the lattice, or NULL.
+ * @return The number of junctions of the lattice.
+ */
+int build_lattice(int side, int Is[], wire ws[]);
+
+/**
+ * Set a different conductance between Y_MIN and Y_MAX on each junction.
+ *
+ * @param Ys The conductances of the junctions.
+ * @param js_count The number of junctions.
+ * @param shift The shift of the pattern, to vary the conductances among
+ * lattices.
+ */
+void vary_conductances(double Ys[], int js_count, int shift);
+
 #endif /* TESTS_H */
@@ -0,0 +1,157 @@
+#include <limits.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "config.h"
+#include "device/network.h"
+#include "stimulator/update.h"
+#include "tests.h"
+#include "util/errors.h"
+#include "util/parallelism.h"
+
+// number of nanowires of the chain used in the tests
+#define WIRES 4000
+
+/**
+ * Return the number of threads of a parallel region of the caller.
+ */
+static int team_threads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Testing that the calibration produces a positive threshold for each
+ * kernel, consistent with the measured costs.
+ */
+void test_calibrate_thresholds()
+{
+    calibration c = calibrate_thresholds();
+
+    assert(c.threads_count == team_threads(), -1, INT_ERROR, "c.threads_count", team_threads(), c.threads_count);
+    for (int g = 0; g < GRAINS_COUNT; g++)
+    {
+        assert(c.unit_times[g] > 0, -1, "The unit time of the kernel %d is not positive\n", g);
+        assert(c.thresholds[g] >= 1, -1, INT_ERROR, "c.thresholds[g]", 1, c.thresholds[g]);
+        assert(team_threads() > 1 || c.thresholds[g] == INT_MAX, -1, INT_ERROR, "c.thresholds[g]", INT_MAX, c.thresholds[g]);
+
+        // the calibration is returned by the queries
+        assert(parallel_threshold(g) == c.thresholds[g], -1, INT_ERROR, "parallel_threshold(g)", c.thresholds[g], parallel_threshold(g));
+    }
+}
+
+/**
+ * Testing that a set threshold is not overwritten by the query of the
+ * calibration, and that the serial and parallel updates are the same.
+ */
+void test_set_parallel_threshold()
+{
+    int Is[WIRES - 1];
+    double serial_Ys[WIRES - 1], parallel_Ys[WIRES - 1], Vs[WIRES];
+    for (int k = 0; k < WIRES - 1; k++)
+    {
+        Is[k] = k * WIRES + k + 1;
+        serial_Ys[k] = parallel_Ys[k] = Y_MIN;
+    }
+    for (int i = 0; i < WIRES; i++)
+    {
+        Vs[i] = (i % 11) * 0.3;
+    }
+
+    connected_component cc = { WIRES, WIRES - 1, 0, 0, Is };
+
+    set_parallel_threshold(UPDATE_GRAIN, INT_MAX);
+    for (int n = 0; n < 10; n++)
+    {
+        update_conductance((network_state){ serial_Ys, Vs }, cc);
+    }
+
+    set_parallel_threshold(UPDATE_GRAIN, 0);
+    calibration c = current_calibration();
+    assert(c.thresholds[UPDATE_GRAIN] == 0, -1, INT_ERROR, "c.thresholds[UPDATE_GRAIN]", 0, c.thresholds[UPDATE_GRAIN]);
+
+    for (int n = 0; n < 10; n++)
+    {
+        update_conductance((network_state){ parallel_Ys, Vs }, cc);
+    }
+
+    for (int k = 0; k < WIRES - 1; k++)
+    {
+        assert(serial_Ys[k] == parallel_Ys[k], -1, DOUBLE_ERROR, "parallel_Ys[k]", serial_Ys[k], parallel_Ys[k]);
+    }
+
+    // restore the calibrated thresholds
+    calibrate_thresholds();
+}
+
+/**
+ * Testing that the thresholds follow the number of threads of the caller,
+ * so that a single-thread caller does not serialize the others.
+ */
+void test_team_thresholds()
+{
+    int threads_count = team_threads();
+    calibration c = calibrate_thresholds();
+
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    assert(parallel_threshold(UPDATE_GRAIN) == INT_MAX, -1, INT_ERROR, "parallel_threshold(UPDATE_GRAIN)", INT_MAX, parallel_threshold(UPDATE_GRAIN));
+
+#ifdef _OPENMP
+    omp_set_num_threads(threads_count);
+#endif
+    for (int g = 0; g < GRAINS_COUNT; g++)
+    {
+        assert(parallel_threshold(g) == c.thresholds[g], -1, INT_ERROR, "parallel_threshold(g)", c.thresholds[g], parallel_threshold(g));
+    }
+
+    // a larger team amortizes the parallel region over more threads
+    if (threads_count > 2)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(2);
+#endif
+        int threshold = parallel_threshold(UPDATE_GRAIN);
+#ifdef _OPENMP
+        omp_set_num_threads(threads_count);
+#endif
+        assert(threshold >= c.thresholds[UPDATE_GRAIN], -1, INT_ERROR, "threshold", c.thresholds[UPDATE_GRAIN], threshold);
+    }
+}
+
+/**
+ * Testing that the calibration does not use more threads than the budget of
+ * the caller (e.g., of a session).
+ */
+void test_calibration_budget()
+{
+    int threads_count = team_threads();
+
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    calibration c = calibrate_thresholds();
+#ifdef _OPENMP
+    omp_set_num_threads(threads_count);
+#endif
+    assert(c.threads_count == 1, -1, INT_ERROR, "c.threads_count", 1, c.threads_count);
+
+    calibrate_thresholds();
+}
+
+int util_parallelism()
+{
+    test_calibrate_thresholds();
+    test_set_parallel_threshold();
+    test_team_thresholds();
+    test_calibration_budget();
+
+    return 0;
+}